@@ -24,6 +24,16 @@ SOFTWARE.
 
 */
 
+// the batched VectorMath functions use AVX when the compiler's been told it can (JOSH_MATH_ENABLE_AVX in CMake),
+// SSE2 is always there on x64
+#if defined(__AVX__)
+	#define JOSH_MATH_AVX 1
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define JOSH_MATH_SSE2 1
+	#include <emmintrin.h>
+#endif
+
 float Math::VectorMath::dotProduct(const Vector2D & vecA, const Vector2D & vecB)
 {
 	return (vecA.x * vecB.x) + (vecA.y * vecB.y);
@@ -150,6 +160,174 @@ Vector3D Math::VectorMath::unitVector(const Vector3D & a)
 	return scaled(unitScale, a);
 }
 
+namespace
+{
+	// as many floats as the widest vector unit there is
+#if defined(JOSH_MATH_AVX)
+	struct Lanes
+	{
+		typedef __m256 Float;
+		enum { count = 8 };
+
+		static Float load(const float * p) { return _mm256_loadu_ps(p); }
+		static void store(float * p, Float v) { _mm256_storeu_ps(p, v); }
+		static Float set(float v) { return _mm256_set1_ps(v); }
+		static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+		static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+		static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+		static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+		static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+	};
+#elif defined(JOSH_MATH_SSE2)
+	struct Lanes
+	{
+		typedef __m128 Float;
+		enum { count = 4 };
+
+		static Float load(const float * p) { return _mm_loadu_ps(p); }
+		static void store(float * p, Float v) { _mm_storeu_ps(p, v); }
+		static Float set(float v) { return _mm_set1_ps(v); }
+		static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+		static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+		static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+		static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+		static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+	};
+#else
+	struct Lanes
+	{
+		typedef float Float;
+		enum { count = 1 };
+
+		static Float load(const float * p) { return *p; }
+		static void store(float * p, Float v) { *p = v; }
+		static Float set(float v) { return v; }
+		static Float add(Float a, Float b) { return a + b; }
+		static Float sub(Float a, Float b) { return a - b; }
+		static Float mul(Float a, Float b) { return a * b; }
+		static Float div(Float a, Float b) { return a / b; }
+		static Float sqrt(Float a) { return sqrtf(a); }
+	};
+#endif
+
+	// the vectors left over at the end of a batch are done one at a time
+	Vector3D vectorAt(const ConstVector3DSpan & span, int i)
+	{
+		Vector3D rv;
+		rv.x = span.x[i];
+		rv.y = span.y[i];
+		rv.z = span.z[i];
+		return rv;
+	}
+
+	void setVectorAt(const Vector3DSpan & span, int i, const Vector3D & value)
+	{
+		span.x[i] = value.x;
+		span.y[i] = value.y;
+		span.z[i] = value.z;
+	}
+}
+
+void Math::VectorMath::dotProduct(const ConstVector3DSpan & vecA, const ConstVector3DSpan & vecB, float * result, int count)
+{
+	int i = 0;
+	for (; i + Lanes::count <= count; i += Lanes::count)
+	{
+		const Lanes::Float xx = Lanes::mul(Lanes::load(vecA.x + i), Lanes::load(vecB.x + i));
+		const Lanes::Float yy = Lanes::mul(Lanes::load(vecA.y + i), Lanes::load(vecB.y + i));
+		const Lanes::Float zz = Lanes::mul(Lanes::load(vecA.z + i), Lanes::load(vecB.z + i));
+		Lanes::store(result + i, Lanes::add(Lanes::add(xx, yy), zz));
+	}
+
+	for (; i < count; ++i)
+	{
+		result[i] = dotProduct(vectorAt(vecA, i), vectorAt(vecB, i));
+	}
+}
+
+void Math::VectorMath::crossProduct(const ConstVector3DSpan & vecA, const ConstVector3DSpan & vecB, const Vector3DSpan & result, int count)
+{
+	int i = 0;
+	for (; i + Lanes::count <= count; i += Lanes::count)
+	{
+		const Lanes::Float ax = Lanes::load(vecA.x + i);
+		const Lanes::Float ay = Lanes::load(vecA.y + i);
+		const Lanes::Float az = Lanes::load(vecA.z + i);
+		const Lanes::Float bx = Lanes::load(vecB.x + i);
+		const Lanes::Float by = Lanes::load(vecB.y + i);
+		const Lanes::Float bz = Lanes::load(vecB.z + i);
+
+		Lanes::store(result.x + i, Lanes::sub(Lanes::mul(ay, bz), Lanes::mul(az, by)));
+		Lanes::store(result.y + i, Lanes::sub(Lanes::mul(az, bx), Lanes::mul(ax, bz)));
+		Lanes::store(result.z + i, Lanes::sub(Lanes::mul(ax, by), Lanes::mul(ay, bx)));
+	}
+
+	for (; i < count; ++i)
+	{
+		setVectorAt(result, i, crossProduct(vectorAt(vecA, i), vectorAt(vecB, i)));
+	}
+}
+
+void Math::VectorMath::add(const ConstVector3DSpan & a, const ConstVector3DSpan & b, const Vector3DSpan & result, int count)
+{
+	int i = 0;
+	for (; i + Lanes::count <= count; i += Lanes::count)
+	{
+		Lanes::store(result.x + i, Lanes::add(Lanes::load(a.x + i), Lanes::load(b.x + i)));
+		Lanes::store(result.y + i, Lanes::add(Lanes::load(a.y + i), Lanes::load(b.y + i)));
+		Lanes::store(result.z + i, Lanes::add(Lanes::load(a.z + i), Lanes::load(b.z + i)));
+	}
+
+	for (; i < count; ++i)
+	{
+		setVectorAt(result, i, add(vectorAt(a, i), vectorAt(b, i)));
+	}
+}
+
+void Math::VectorMath::scaled(float scale, const ConstVector3DSpan & toScale, const Vector3DSpan & result, int count)
+{
+	const Lanes::Float scales = Lanes::set(scale);
+
+	int i = 0;
+	for (; i + Lanes::count <= count; i += Lanes::count)
+	{
+		Lanes::store(result.x + i, Lanes::mul(Lanes::load(toScale.x + i), scales));
+		Lanes::store(result.y + i, Lanes::mul(Lanes::load(toScale.y + i), scales));
+		Lanes::store(result.z + i, Lanes::mul(Lanes::load(toScale.z + i), scales));
+	}
+
+	for (; i < count; ++i)
+	{
+		setVectorAt(result, i, scaled(scale, vectorAt(toScale, i)));
+	}
+}
+
+void Math::VectorMath::unitVector(const ConstVector3DSpan & a, const Vector3DSpan & result, int count)
+{
+	const Lanes::Float ones = Lanes::set(1.0f);
+
+	int i = 0;
+	for (; i + Lanes::count <= count; i += Lanes::count)
+	{
+		const Lanes::Float x = Lanes::load(a.x + i);
+		const Lanes::Float y = Lanes::load(a.y + i);
+		const Lanes::Float z = Lanes::load(a.z + i);
+
+		// a real divide rather than rsqrt, so it matches the single vector version exactly
+		const Lanes::Float magnitudeSquared = Lanes::add(Lanes::add(Lanes::mul(x, x), Lanes::mul(y, y)), Lanes::mul(z, z));
+		const Lanes::Float unitScale = Lanes::div(ones, Lanes::sqrt(magnitudeSquared));
+
+		Lanes::store(result.x + i, Lanes::mul(x, unitScale));
+		Lanes::store(result.y + i, Lanes::mul(y, unitScale));
+		Lanes::store(result.z + i, Lanes::mul(z, unitScale));
+	}
+
+	for (; i < count; ++i)
+	{
+		setVectorAt(result, i, unitVector(vectorAt(a, i)));
+	}
+}
+
 float Math::VectorMath::lookAt2D(const Vector2D & currentlyLookingAtPos, const Vector2D & toLookAtPos, const Vector2D & currentPos)// note the parameters passed should be points to look at
 {
 	// need unit vectors from eye position to currently facing position & eye position to position want to look at
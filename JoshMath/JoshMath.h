@@ -57,6 +57,14 @@ namespace Math
 		Vector2D unitVector(const Vector2D & a);
 		Vector3D unitVector(const Vector3D & a);
 
+		// batched versions over count vectors, worked out the same way as calling the ones above for each vector in turn but
+		// several at once with SSE2 / AVX. the result can be the same arrays as an input but mustn't overlap them any other way
+		void dotProduct(const ConstVector3DSpan & vecA, const ConstVector3DSpan & vecB, float * result, int count);
+		void crossProduct(const ConstVector3DSpan & vecA, const ConstVector3DSpan & vecB, const Vector3DSpan & result, int count);
+		void add(const ConstVector3DSpan & a, const ConstVector3DSpan & b, const Vector3DSpan & result, int count);
+		void scaled(float scale, const ConstVector3DSpan & toScale, const Vector3DSpan & result, int count);
+		void unitVector(const ConstVector3DSpan & a, const Vector3DSpan & result, int count);
+
 		float lookAt2D(const Vector2D & currentlyLookingAtPos, const Vector2D & toLookAtPos, const Vector2D & currentPos);// return angle to rotate by in radians
 		Matrix4x4 lookAt3D(Vector3D & position, Vector3D & targetPosition, Vector3D & upVec);
 	}
@@ -34,6 +34,29 @@ struct Vector3D
 	float x, y, z;
 };
 
+// count vectors laid out as a structure of arrays, every x in one array, every y in the next & every z in the last.
+// for the batched VectorMath functions, which work through several vectors at a time
+struct Vector3DSpan
+{
+	Vector3DSpan() : x(nullptr), y(nullptr), z(nullptr) {}
+	Vector3DSpan(float * xs, float * ys, float * zs) : x(xs), y(ys), z(zs) {}
+
+	float * x;
+	float * y;
+	float * z;
+};
+
+struct ConstVector3DSpan
+{
+	ConstVector3DSpan() : x(nullptr), y(nullptr), z(nullptr) {}
+	ConstVector3DSpan(const float * xs, const float * ys, const float * zs) : x(xs), y(ys), z(zs) {}
+	ConstVector3DSpan(const Vector3DSpan & span) : x(span.x), y(span.y), z(span.z) {}
+
+	const float * x;
+	const float * y;
+	const float * z;
+};
+
 struct Quaternion
 {
 	float w, x, y, z;
@@ -0,0 +1,112 @@
+#include "BlockCompression.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace MapGen;
+
+	typedef Simd::Lanes Lanes;
+	typedef Lanes::Float Float;
+	typedef Lanes::Int Int;
+
+	// BC4 index of each of the 8 palette positions from the minimum (0) to the maximum (7). index 0 is the
+	// first endpoint (the maximum), 1 the second (the minimum) & 2 - 7 the steps from the maximum down
+	const unsigned int paletteIndex[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+	// one 8 byte BC4 block from the channel at bit shift of 16 pixels. the endpoints are the channel's maximum & minimum,
+	// which always picks the 8 value mode, & every pixel takes the nearest of the evenly spaced values between them
+	template <int shift>
+	void encodeChannel(const Pixel * pixels, unsigned char * out)
+	{
+		int minimum = 255, maximum = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			const int value = (pixels[i] >> shift) & 0xff;
+			minimum = std::min(minimum, value);
+			maximum = std::max(maximum, value);
+		}
+
+		out[0] = static_cast<unsigned char>(maximum);
+		out[1] = static_cast<unsigned char>(minimum);
+
+		uint64_t indices = 0;
+		if (maximum > minimum)
+		{
+			// palette position 0 - 7 of every pixel, rounded to the nearest
+			const Float minimumLanes = Lanes::set(static_cast<float>(minimum));
+			const Float scale = Lanes::set(7.0f / static_cast<float>(maximum - minimum));
+			const Float half = Lanes::set(0.5f);
+			const Int channelMask = Lanes::setInt(0xff);
+
+			Pixel positions[16];
+			for (int i = 0; i < 16; i += Lanes::count)
+			{
+				const Float value = Lanes::toFloat(Lanes::bitAnd(Lanes::shiftRight<shift>(Lanes::loadPixels(pixels + i)), channelMask));
+				Lanes::storePixels(positions + i, Lanes::truncate(Lanes::add(Lanes::mul(Lanes::sub(value, minimumLanes), scale), half)));
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				indices |= static_cast<uint64_t>(paletteIndex[positions[i]]) << (i * 3);
+			}
+		}
+
+		// 16 3 bit indices, little endian
+		for (int i = 0; i < 6; ++i)
+		{
+			out[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+		}
+	}
+
+	void compressBlockRows(const ConstImageView & image, unsigned char * blocks, int firstBlockRow, int lastBlockRow)
+	{
+		const int blocksWide = (image.width + 3) / 4;
+
+		Pixel block[16];
+		for (int blockRow = firstBlockRow; blockRow < lastBlockRow; ++blockRow)
+		{
+			unsigned char * out = blocks + static_cast<size_t>(blockRow) * blocksWide * 16;
+
+			for (int blockColumn = 0; blockColumn < blocksWide; ++blockColumn)
+			{
+				// gather the 4x4 pixels, repeating the edge ones for blocks that hang over the edge
+				for (int y = 0; y < 4; ++y)
+				{
+					const Pixel * row = image.row(std::min(blockRow * 4 + y, image.height - 1));
+					for (int x = 0; x < 4; ++x)
+					{
+						block[y * 4 + x] = row[std::min(blockColumn * 4 + x, image.width - 1)];
+					}
+				}
+
+				// red (x) then green (y)
+				encodeChannel<16>(block, out);
+				encodeChannel<8>(block, out + 8);
+				out += 16;
+			}
+		}
+	}
+}
+
+size_t MapGen::bc5Size(int width, int height)
+{
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * 16;
+}
+
+void MapGen::compressBC5(const ConstImageView & image, unsigned char * blocks)
+{
+	compressBlockRows(image, blocks, 0, (image.height + 3) / 4);
+}
+
+void MapGen::compressBC5(const ConstImageView & image, unsigned char * blocks, ThreadPool & threadPool)
+{
+	const int blockRows = (image.height + 3) / 4;
+	const int blockRowsPerChunk = std::max(1, blockRows / static_cast<int>(threadPool.threadCount() * 4));
+
+	threadPool.parallelFor(blockRows, blockRowsPerChunk, [&](int firstBlockRow, int lastBlockRow)
+	{
+		compressBlockRows(image, blocks, firstBlockRow, lastBlockRow);
+	});
+}
@@ -0,0 +1,23 @@
+#ifndef _BLOCK_COMPRESSION_H_
+#define _BLOCK_COMPRESSION_H_
+
+#include "ImageBuffer.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+
+namespace MapGen
+{
+	// bytes of BC5 data for a width x height image, 16 bytes for every 4x4 block
+	size_t bc5Size(int width, int height);
+
+	// compresses the red & green channels of image (the x & y of a normal map, the shader works z back out) to BC5.
+	// blocks are written left to right, top to bottom & must be bc5Size() bytes. the blocks hanging over the right &
+	// bottom edges repeat the last row & column of pixels
+	void compressBC5(const ConstImageView & image, unsigned char * blocks);
+
+	// same as above, split into rows of blocks across the thread pool. the output is identical
+	void compressBC5(const ConstImageView & image, unsigned char * blocks, ThreadPool & threadPool);
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _BORDER_MODE_H_
+#define _BORDER_MODE_H_
+
+namespace MapGen
+{
+	// what the generators see past the edges of a map
+	enum class BorderMode
+	{
+		Zero, // heights past the edges are 0, which is how maps have always been generated
+		Clamp, // the edge heights carry on outwards, so the edges come out flat
+		Wrap // the opposite edge, for tiling textures without seams
+	};
+}
+
+#endif
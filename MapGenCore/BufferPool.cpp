@@ -0,0 +1,204 @@
+#include "BufferPool.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+MapGen::PooledBuffer::PooledBuffer()
+	: m_pool(nullptr)
+	, m_data(nullptr)
+	, m_size(0)
+	, m_capacity(0)
+{
+}
+
+MapGen::PooledBuffer::~PooledBuffer()
+{
+	reset();
+}
+
+MapGen::PooledBuffer::PooledBuffer(PooledBuffer && other)
+	: m_pool(other.m_pool)
+	, m_data(other.m_data)
+	, m_size(other.m_size)
+	, m_capacity(other.m_capacity)
+{
+	other.m_pool = nullptr;
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_capacity = 0;
+}
+
+MapGen::PooledBuffer & MapGen::PooledBuffer::operator=(PooledBuffer && other)
+{
+	if (this != &other)
+	{
+		reset();
+		m_pool = other.m_pool;
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_capacity = other.m_capacity;
+		other.m_pool = nullptr;
+		other.m_data = nullptr;
+		other.m_size = 0;
+		other.m_capacity = 0;
+	}
+	return *this;
+}
+
+void MapGen::PooledBuffer::reset()
+{
+	if (m_pool)
+	{
+		m_pool->release(m_data, m_capacity);
+	}
+	m_pool = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+bool MapGen::PooledBuffer::isEmpty() const
+{
+	return m_size == 0;
+}
+
+size_t MapGen::PooledBuffer::size() const
+{
+	return m_size;
+}
+
+unsigned char * MapGen::PooledBuffer::data() const
+{
+	return m_data;
+}
+
+MapGen::BufferPool::BufferPool(size_t maxKeptBytes)
+	: m_keptBytes(0)
+	, m_maxKeptBytes(maxKeptBytes)
+{
+}
+
+MapGen::BufferPool::~BufferPool()
+{
+	trim();
+}
+
+MapGen::PooledBuffer MapGen::BufferPool::acquire(size_t bytes)
+{
+	PooledBuffer buffer;
+	if (bytes == 0)
+	{
+		return buffer;
+	}
+
+	{
+		// the smallest kept block that fits, there's only ever a handful
+		std::lock_guard<std::mutex> lock(m_mutex);
+		size_t best = m_kept.size();
+		for (size_t i = 0; i < m_kept.size(); ++i)
+		{
+			const size_t capacity = m_kept[i].capacity;
+			if (capacity >= bytes && capacity / 2 <= bytes && (best == m_kept.size() || capacity < m_kept[best].capacity))
+			{
+				best = i;
+			}
+		}
+
+		if (best < m_kept.size())
+		{
+			buffer.m_data = m_kept[best].data;
+			buffer.m_capacity = m_kept[best].capacity;
+			m_keptBytes -= buffer.m_capacity;
+			m_kept.erase(m_kept.begin() + best);
+		}
+	}
+
+	if (!buffer.m_data)
+	{
+		buffer.m_data = allocate(bytes);
+		buffer.m_capacity = bytes;
+	}
+	buffer.m_pool = this;
+	buffer.m_size = bytes;
+	return buffer;
+}
+
+void MapGen::BufferPool::trim()
+{
+	std::vector<Block> kept;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		kept.swap(m_kept);
+		m_keptBytes = 0;
+	}
+
+	for (const Block & block : kept)
+	{
+		deallocate(block.data);
+	}
+}
+
+size_t MapGen::BufferPool::keptBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_keptBytes;
+}
+
+MapGen::BufferPool & MapGen::BufferPool::defaultPool()
+{
+	static BufferPool * pool = new BufferPool();
+	return *pool;
+}
+
+void MapGen::BufferPool::release(unsigned char * data, size_t capacity)
+{
+	if (capacity > m_maxKeptBytes)
+	{
+		deallocate(data);
+		return;
+	}
+
+	// the oldest go first to make room
+	std::vector<Block> evicted;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		size_t evictedCount = 0;
+		while (m_keptBytes + capacity > m_maxKeptBytes)
+		{
+			m_keptBytes -= m_kept[evictedCount].capacity;
+			++evictedCount;
+		}
+		evicted.assign(m_kept.begin(), m_kept.begin() + evictedCount);
+		m_kept.erase(m_kept.begin(), m_kept.begin() + evictedCount);
+
+		Block block = { data, capacity };
+		m_kept.push_back(block);
+		m_keptBytes += capacity;
+	}
+
+	for (const Block & block : evicted)
+	{
+		deallocate(block.data);
+	}
+}
+
+unsigned char * MapGen::BufferPool::allocate(size_t capacity)
+{
+	// over allocated & rounded up, with what malloc gave stashed just before the block so it can be freed
+	unsigned char * const raw = static_cast<unsigned char *>(std::malloc(capacity + alignment + sizeof(void *)));
+	if (!raw)
+	{
+		throw std::bad_alloc();
+	}
+
+	const uintptr_t start = reinterpret_cast<uintptr_t>(raw + sizeof(void *));
+	unsigned char * const data = reinterpret_cast<unsigned char *>((start + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+	reinterpret_cast<void **>(data)[-1] = raw;
+	return data;
+}
+
+void MapGen::BufferPool::deallocate(unsigned char * data)
+{
+	std::free(reinterpret_cast<void **>(data)[-1]);
+}
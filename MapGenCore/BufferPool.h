@@ -0,0 +1,96 @@
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace MapGen
+{
+	class BufferPool;
+
+	// a block from a BufferPool, given back to it when this is destroyed or reset. move only
+	class PooledBuffer
+	{
+	public:
+		PooledBuffer();
+		~PooledBuffer();
+
+		PooledBuffer(PooledBuffer && other);
+		PooledBuffer & operator=(PooledBuffer && other);
+
+		PooledBuffer(const PooledBuffer &) = delete;
+		PooledBuffer & operator=(const PooledBuffer &) = delete;
+
+		// gives the block back now
+		void reset();
+
+		bool isEmpty() const;
+
+		// the size asked for, the block itself can be a bit bigger
+		size_t size() const;
+		unsigned char * data() const;
+
+		template<typename T>
+		T * as() const
+		{
+			return reinterpret_cast<T *>(m_data);
+		}
+
+	private:
+		friend class BufferPool;
+
+		BufferPool * m_pool;
+		unsigned char * m_data;
+		size_t m_size, m_capacity;
+	};
+
+	// hands out cache line aligned blocks & keeps the ones given back, so the planes of the next map the same size (the
+	// heights, gradients & output of a regenerate, or the next texture of a batch) reuse memory that's already mapped in
+	// rather than page faulting in fresh. thread safe
+	class BufferPool
+	{
+	public:
+		static const size_t alignment = 64;
+
+		// blocks given back are freed once keeping them would take the pool over maxKeptBytes. the default holds the
+		// heights, gradients & output of a 4K map, bigger ones page fault in fresh rather than sit idle between maps
+		explicit BufferPool(size_t maxKeptBytes = size_t(256) << 20);
+		~BufferPool();
+
+		BufferPool(const BufferPool &) = delete;
+		BufferPool & operator=(const BufferPool &) = delete;
+
+		// the contents are whatever was left in it. a kept block is reused if it's at least bytes & no more than twice it
+		PooledBuffer acquire(size_t bytes);
+
+		// frees every kept block
+		void trim();
+
+		size_t keptBytes() const;
+
+		// pool shared by everything that doesn't need its own. never destroyed, so buffers can outlive statics
+		static BufferPool & defaultPool();
+
+	private:
+		friend class PooledBuffer;
+
+		struct Block
+		{
+			unsigned char * data;
+			size_t capacity;
+		};
+
+		void release(unsigned char * data, size_t capacity);
+
+		static unsigned char * allocate(size_t capacity);
+		static void deallocate(unsigned char * data);
+
+		mutable std::mutex m_mutex;
+		std::vector<Block> m_kept; // oldest first
+		size_t m_keptBytes;
+		size_t m_maxKeptBytes;
+	};
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "DdsFile.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+	// values from the DirectX dds.h / dxgiformat.h headers
+	const uint32_t headerSize = 124;
+	const uint32_t pixelFormatSize = 32;
+
+	const uint32_t flagCaps = 0x1;
+	const uint32_t flagHeight = 0x2;
+	const uint32_t flagWidth = 0x4;
+	const uint32_t flagPixelFormat = 0x1000;
+	const uint32_t flagMipMapCount = 0x20000;
+	const uint32_t flagLinearSize = 0x80000;
+
+	const uint32_t pixelFormatFourCC = 0x4;
+
+	const uint32_t capsComplex = 0x8;
+	const uint32_t capsTexture = 0x1000;
+	const uint32_t capsMipMap = 0x400000;
+
+	const uint32_t dxgiFormatBC5Unorm = 83;
+	const uint32_t resourceDimensionTexture2D = 3;
+
+	uint32_t fourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+	}
+
+	void appendWord(std::vector<unsigned char> & bytes, uint32_t word)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			bytes.push_back(static_cast<unsigned char>(word >> (i * 8)));
+		}
+	}
+}
+
+bool MapGen::writeDdsBC5(const std::string & path, int width, int height, const std::vector<std::vector<unsigned char>> & levels)
+{
+	if (levels.empty() || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	const bool hasMips = levels.size() > 1;
+	std::vector<unsigned char> header;
+
+	appendWord(header, fourCC('D', 'D', 'S', ' '));
+
+	appendWord(header, headerSize);
+	appendWord(header, flagCaps | flagHeight | flagWidth | flagPixelFormat | flagLinearSize | (hasMips ? flagMipMapCount : 0));
+	appendWord(header, static_cast<uint32_t>(height));
+	appendWord(header, static_cast<uint32_t>(width));
+	appendWord(header, static_cast<uint32_t>(levels[0].size()));
+	appendWord(header, 0); // depth
+	appendWord(header, static_cast<uint32_t>(levels.size()));
+	for (int i = 0; i < 11; ++i)
+	{
+		appendWord(header, 0); // reserved
+	}
+
+	// the real format is in the DX10 header that follows
+	appendWord(header, pixelFormatSize);
+	appendWord(header, pixelFormatFourCC);
+	appendWord(header, fourCC('D', 'X', '1', '0'));
+	for (int i = 0; i < 5; ++i)
+	{
+		appendWord(header, 0); // rgb bit count & masks
+	}
+
+	appendWord(header, capsTexture | (hasMips ? capsComplex | capsMipMap : 0));
+	for (int i = 0; i < 4; ++i)
+	{
+		appendWord(header, 0); // caps2 - 4 & reserved
+	}
+
+	appendWord(header, dxgiFormatBC5Unorm);
+	appendWord(header, resourceDimensionTexture2D);
+	appendWord(header, 0); // misc flags
+	appendWord(header, 1); // array size
+	appendWord(header, 0); // alpha mode, not applicable
+
+	std::FILE * file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+	for (size_t level = 0; level < levels.size() && written; ++level)
+	{
+		written = std::fwrite(levels[level].data(), 1, levels[level].size(), file) == levels[level].size();
+	}
+
+	return std::fclose(file) == 0 && written;
+}
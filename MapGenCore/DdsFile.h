@@ -0,0 +1,14 @@
+#ifndef _DDS_FILE_H_
+#define _DDS_FILE_H_
+
+#include <string>
+#include <vector>
+
+namespace MapGen
+{
+	// writes BC5 blocks (see compressBC5) as a DDS texture with a DX10 header (DXGI_FORMAT_BC5_UNORM).
+	// levels[0] is the full size width x height image, any after it are its mip chain down from there
+	bool writeDdsBC5(const std::string & path, int width, int height, const std::vector<std::vector<unsigned char>> & levels);
+}
+
+#endif
@@ -0,0 +1,214 @@
+#include "EdgeMapKernel.h"
+#include "Simd.h"
+
+namespace
+{
+	using namespace MapGen;
+
+	typedef Simd::Lanes Lanes;
+	typedef Lanes::Float Float;
+	typedef Lanes::Int Int;
+
+	// Kernels::colourDifference of Lanes::count pixel pairs, alpha is ignored
+	inline Int colourDifferences(Int a, Int b)
+	{
+		const Int channelMask = Lanes::setInt(0xff);
+		const Int diff = Lanes::absDiffBytes(a, b);
+
+		const Int blue = Lanes::bitAnd(diff, channelMask);
+		const Int green = Lanes::bitAnd(Lanes::shiftRight<8>(diff), channelMask);
+		const Int red = Lanes::bitAnd(Lanes::shiftRight<16>(diff), channelMask);
+		return Lanes::addInt(Lanes::addInt(red, green), blue);
+	}
+
+	inline Pixel edgePixel(const Pixel * above, const Pixel * row, int x, int sensitivity, Pixel primaryColour, Pixel edgeColour)
+	{
+		const bool verticalEdge = above && Kernels::colourDifference(above[x], row[x]) > sensitivity;
+		const bool horizontalEdge = x > 0 && Kernels::colourDifference(row[x - 1], row[x]) > sensitivity;
+		return (verticalEdge || horizontalEdge) ? edgeColour : primaryColour;
+	}
+}
+
+void MapGen::Kernels::edgeMapRow(const Pixel * above, const Pixel * row, int width, int sensitivity, Pixel primaryColour, Pixel edgeColour, Pixel * out)
+{
+	if (width <= 0)
+	{
+		return;
+	}
+
+	// the first pixel has nothing to its left
+	out[0] = edgePixel(above, row, 0, sensitivity, primaryColour, edgeColour);
+
+	const Int sensitivityLanes = Lanes::setInt(sensitivity);
+	const Int primaryLanes = Lanes::setInt(static_cast<int>(primaryColour));
+	const Int edgeLanes = Lanes::setInt(static_cast<int>(edgeColour));
+
+	int x = 1;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int current = Lanes::loadPixels(row + x);
+
+		Int isEdge = Lanes::greaterThan(colourDifferences(Lanes::loadPixels(row + x - 1), current), sensitivityLanes);
+		if (above)
+		{
+			isEdge = Lanes::bitOr(isEdge, Lanes::greaterThan(colourDifferences(Lanes::loadPixels(above + x), current), sensitivityLanes));
+		}
+
+		Lanes::storePixels(out + x, Lanes::select(isEdge, edgeLanes, primaryLanes));
+	}
+
+	for (; x < width; ++x)
+	{
+		out[x] = edgePixel(above, row, x, sensitivity, primaryColour, edgeColour);
+	}
+}
+
+void MapGen::Kernels::intensityRow(const Pixel * in, int width, int * intensity)
+{
+	const Int channelMask = Lanes::setInt(0xff);
+
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int px = Lanes::loadPixels(in + x);
+		const Int red = Lanes::bitAnd(Lanes::shiftRight<16>(px), channelMask);
+		const Int green = Lanes::bitAnd(Lanes::shiftRight<8>(px), channelMask);
+		const Int blue = Lanes::bitAnd(px, channelMask);
+		Lanes::storeInts(intensity + x, Lanes::addInt(Lanes::addInt(red, green), blue));
+	}
+
+	for (; x < width; ++x)
+	{
+		intensity[x] = pixelRed(in[x]) + pixelGreen(in[x]) + pixelBlue(in[x]);
+	}
+}
+
+void MapGen::Kernels::sobelRowPass(const int * intensity, int width, int * smoothed, int * differences)
+{
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int left = Lanes::loadInts(intensity + x - 1);
+		const Int centre = Lanes::loadInts(intensity + x);
+		const Int right = Lanes::loadInts(intensity + x + 1);
+		Lanes::storeInts(smoothed + x, Lanes::addInt(Lanes::addInt(left, right), Lanes::shiftLeft<1>(centre)));
+		Lanes::storeInts(differences + x, Lanes::subInt(right, left));
+	}
+
+	for (; x < width; ++x)
+	{
+		smoothed[x] = intensity[x - 1] + intensity[x + 1] + intensity[x] * 2;
+		differences[x] = intensity[x + 1] - intensity[x - 1];
+	}
+}
+
+void MapGen::Kernels::sobelColumnPass(const int * smoothedAbove, const int * smoothedBelow, const int * differencesAbove, const int * differences,
+	const int * differencesBelow, int width, int * gx, int * gy, int * magnitude)
+{
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int across = Lanes::addInt(Lanes::addInt(Lanes::loadInts(differencesAbove + x), Lanes::loadInts(differencesBelow + x)),
+			Lanes::shiftLeft<1>(Lanes::loadInts(differences + x)));
+		const Int down = Lanes::subInt(Lanes::loadInts(smoothedBelow + x), Lanes::loadInts(smoothedAbove + x));
+
+		Lanes::storeInts(gx + x, across);
+		Lanes::storeInts(gy + x, down);
+		Lanes::storeInts(magnitude + x, Lanes::addInt(Lanes::absInt(across), Lanes::absInt(down)));
+	}
+
+	for (; x < width; ++x)
+	{
+		gx[x] = differencesAbove[x] + differencesBelow[x] + differences[x] * 2;
+		gy[x] = smoothedBelow[x] - smoothedAbove[x];
+		magnitude[x] = abs(gx[x]) + abs(gy[x]);
+	}
+}
+
+void MapGen::Kernels::thresholdRow(const int * magnitude, int width, int threshold, Pixel primaryColour, Pixel edgeColour, Pixel * out)
+{
+	const Int thresholdLanes = Lanes::setInt(threshold);
+	const Int primaryLanes = Lanes::setInt(static_cast<int>(primaryColour));
+	const Int edgeLanes = Lanes::setInt(static_cast<int>(edgeColour));
+
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int isEdge = Lanes::greaterThan(Lanes::loadInts(magnitude + x), thresholdLanes);
+		Lanes::storePixels(out + x, Lanes::select(isEdge, edgeLanes, primaryLanes));
+	}
+
+	for (; x < width; ++x)
+	{
+		out[x] = magnitude[x] > threshold ? edgeColour : primaryColour;
+	}
+}
+
+void MapGen::Kernels::cannyGradientRow(const int * gx, const int * gy, const int * magnitude, int width, unsigned short * magnitudeOut, unsigned char * directions)
+{
+	// tan 22.5 & tan 67.5 degrees in 256ths, so the direction is picked without dividing. the products are worked out as
+	// floats (there's no 32 bit multiply before SSE4.1) but they're all well under 2^24 so they come out exact
+	const int shallow = 106;
+	const int steep = 618;
+
+	const Float shallowLanes = Lanes::set(static_cast<float>(shallow));
+	const Float steepLanes = Lanes::set(static_cast<float>(steep));
+	const Int zero = Lanes::setInt(0);
+	const Int one = Lanes::setInt(1);
+	const Int two = Lanes::setInt(2);
+
+	// picked with selects rather than ifs, on noisy images the directions are too random to predict
+	int directionBlock[Lanes::count];
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		const Int across = Lanes::loadInts(gx + x);
+		const Int down = Lanes::loadInts(gy + x);
+		const Float acrossSize = Lanes::toFloat(Lanes::absInt(across));
+		const Int downSize = Lanes::shiftLeft<8>(Lanes::absInt(down));
+
+		// 2 when the signs are the same (down & right or up & left), 3 when they aren't
+		const Int diagonal = Lanes::addInt(two, Lanes::shiftRight<31>(Lanes::bitXor(across, down)));
+		const Int notShallow = Lanes::greaterThan(downSize, Lanes::truncate(Lanes::mul(acrossSize, shallowLanes)));
+		const Int notSteep = Lanes::greaterThan(Lanes::truncate(Lanes::mul(acrossSize, steepLanes)), downSize);
+
+		Lanes::storeInts(directionBlock, Lanes::select(notShallow, Lanes::select(notSteep, diagonal, one), zero));
+		for (int i = 0; i < Lanes::count; ++i)
+		{
+			magnitudeOut[x + i] = static_cast<unsigned short>(magnitude[x + i]);
+			directions[x + i] = static_cast<unsigned char>(directionBlock[i]);
+		}
+	}
+
+	for (; x < width; ++x)
+	{
+		const int acrossSize = abs(gx[x]);
+		const int downSize = abs(gy[x]) * 256;
+		const int diagonal = 2 + ((gx[x] ^ gy[x]) < 0);
+
+		magnitudeOut[x] = static_cast<unsigned short>(magnitude[x]);
+		directions[x] = static_cast<unsigned char>(downSize <= acrossSize * shallow ? 0 : (downSize >= acrossSize * steep ? 1 : diagonal));
+	}
+}
+
+void MapGen::Kernels::cannySuppressRow(const unsigned short * above, const unsigned short * row, const unsigned short * below, int width, int low, int high, unsigned char * directions)
+{
+	// the two neighbours across the gradient for each direction, as which of the three rows & how far along it
+	const unsigned short * rows[3] = { above, row, below };
+	const int beforeRow[4] = { 1, 0, 0, 0 };
+	const int beforeStep[4] = { -1, 0, -1, 1 };
+	const int afterRow[4] = { 1, 2, 2, 2 };
+	const int afterStep[4] = { 1, 0, 1, -1 };
+
+	for (int x = 0; x < width; ++x)
+	{
+		const int direction = directions[x];
+		const int magnitude = row[x];
+		const int before = rows[beforeRow[direction]][x + beforeStep[direction]];
+		const int after = rows[afterRow[direction]][x + afterStep[direction]];
+
+		// >= on one side so a plateau two pixels wide still keeps one of them
+		const int kept = (magnitude > before) & (magnitude >= after) & (magnitude > low);
+		directions[x] = static_cast<unsigned char>(kept * (magnitude > high ? cannyStrong : cannyWeak));
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef _EDGE_MAP_KERNEL_H_
+#define _EDGE_MAP_KERNEL_H_
+
+#include "ImageBuffer.h"
+
+#include <cstdlib>
+
+// row kernels shared by the edge map generators, not part of the public interface
+namespace MapGen
+{
+	namespace Kernels
+	{
+		// summed absolute difference of the red, green & blue channels, 0 - 765
+		inline int colourDifference(const Pixel a, const Pixel b)
+		{
+			return abs(pixelRed(a) - pixelRed(b)) + abs(pixelGreen(a) - pixelGreen(b)) + abs(pixelBlue(a) - pixelBlue(b));
+		}
+
+		// one edge map row in a single pass, a pixel is an edge if it differs by more than sensitivity from the
+		// pixel to its left or the one above it. above is null for the top row of the image
+		void edgeMapRow(const Pixel * above, const Pixel * row, int width, int sensitivity, Pixel primaryColour, Pixel edgeColour, Pixel * out);
+
+		// the Sobel & Canny detectors work on the summed red, green & blue of each pixel, 0 - 765 like colourDifference
+		void intensityRow(const Pixel * in, int width, int * intensity);
+
+		// the across half of the separable 3x3 Sobel, smoothed is 1 2 1 & differences right - left.
+		// intensity has to have a value either side of the row, intensity[-1] & intensity[width]
+		void sobelRowPass(const int * intensity, int width, int * smoothed, int * differences);
+
+		// the down half, from the across passes of the rows above, on & below. gx is 1 2 1 down the differences & gy
+		// below - above of the smoothed rows, magnitude |gx| + |gy|. a step of n between two pixels gives a magnitude of 4n
+		void sobelColumnPass(const int * smoothedAbove, const int * smoothedBelow, const int * differencesAbove, const int * differences,
+			const int * differencesBelow, int width, int * gx, int * gy, int * magnitude);
+
+		// edgeColour where magnitude > threshold, primaryColour everywhere else
+		void thresholdRow(const int * magnitude, int width, int threshold, Pixel primaryColour, Pixel edgeColour, Pixel * out);
+
+		// which way each pixel's gradient points, for Canny's thinning: 0 across, 1 down, 2 down & right or up & left,
+		// 3 down & left or up & right. the magnitude is kept as 16 bits, it's never more than 6120
+		void cannyGradientRow(const int * gx, const int * gy, const int * magnitude, int width, unsigned short * magnitudeOut, unsigned char * directions);
+
+		// what each pixel is to Canny once it's been thinned, cannyEdge is for the generator to mark them as it follows edges
+		enum { cannyNone = 0, cannyWeak = 1, cannyStrong = 2, cannyEdge = 3 };
+
+		// Canny's thinning & double threshold. the magnitude rows need a 0 either side, directions is overwritten in
+		// place with cannyNone where the pixel isn't the peak across its gradient or isn't above low, cannyWeak if it's
+		// only above low & cannyStrong above high
+		void cannySuppressRow(const unsigned short * above, const unsigned short * row, const unsigned short * below, int width, int low, int high, unsigned char * directions);
+	}
+}
+
+#endif
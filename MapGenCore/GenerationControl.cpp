@@ -0,0 +1,57 @@
+#include "GenerationControl.h"
+
+MapGen::GenerationControl::GenerationControl()
+	: m_cancelled(false)
+	, m_rowsDone(0)
+	, m_totalRows(0)
+	, m_stageTimings(nullptr)
+{
+}
+
+void MapGen::GenerationControl::cancel()
+{
+	m_cancelled = true;
+}
+
+bool MapGen::GenerationControl::isCancelled() const
+{
+	return m_cancelled.load(std::memory_order_relaxed);
+}
+
+void MapGen::GenerationControl::setTotalRows(long long totalRows)
+{
+	m_totalRows = totalRows;
+	m_rowsDone = 0;
+}
+
+void MapGen::GenerationControl::setProgressCallback(std::function<void(int percent)> callback)
+{
+	m_progressCallback = callback;
+}
+
+void MapGen::GenerationControl::rowsDone(int rows)
+{
+	const long long before = m_rowsDone.fetch_add(rows);
+	if (!m_progressCallback || m_totalRows <= 0)
+	{
+		return;
+	}
+
+	// only report when the whole percentage changes so the receiver isn't flooded
+	const int percentBefore = static_cast<int>(before * 100 / m_totalRows);
+	const int percentAfter = static_cast<int>((before + rows) * 100 / m_totalRows);
+	if (percentAfter != percentBefore)
+	{
+		m_progressCallback(percentAfter > 100 ? 100 : percentAfter);
+	}
+}
+
+void MapGen::GenerationControl::setStageTimings(StageTimings * timings)
+{
+	m_stageTimings = timings;
+}
+
+MapGen::StageTimings * MapGen::GenerationControl::stageTimings() const
+{
+	return m_stageTimings;
+}
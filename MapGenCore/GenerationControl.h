@@ -0,0 +1,47 @@
+#ifndef _GENERATION_CONTROL_H_
+#define _GENERATION_CONTROL_H_
+
+#include "StageTimings.h"
+
+#include <atomic>
+#include <functional>
+
+namespace MapGen
+{
+	// lets another thread follow the progress of a generation & cancel it. the generators check
+	// isCancelled() before every row & give up early, leaving the output partly written
+	class GenerationControl
+	{
+	public:
+		GenerationControl();
+
+		GenerationControl(const GenerationControl &) = delete;
+		GenerationControl & operator=(const GenerationControl &) = delete;
+
+		void cancel();
+		bool isCancelled() const;
+
+		// total number of rows the whole job will go through, add up the rows of every step when
+		// a job is made of more than one (building a height field then a normal map etc.)
+		void setTotalRows(long long totalRows);
+
+		// called with the percentage done each time it goes up, from whichever thread finished the rows
+		void setProgressCallback(std::function<void(int percent)> callback);
+
+		// called by the generators, thread safe
+		void rowsDone(int rows);
+
+		// where the generators add how long each of their stages took (heights, gradients, packing etc.), optional
+		void setStageTimings(StageTimings * timings);
+		StageTimings * stageTimings() const;
+
+	private:
+		std::atomic<bool> m_cancelled;
+		std::atomic<long long> m_rowsDone;
+		long long m_totalRows;
+		std::function<void(int percent)> m_progressCallback;
+		StageTimings * m_stageTimings;
+	};
+}
+
+#endif
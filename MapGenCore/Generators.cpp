@@ -0,0 +1,663 @@
+#include "Generators.h"
+#include "BufferPool.h"
+#include "EdgeMapKernel.h"
+#include "NormalMapKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace
+{
+	using namespace MapGen;
+
+	inline bool isCancelled(const GenerationControl * control)
+	{
+		return control && control->isCancelled();
+	}
+
+	inline void rowDone(GenerationControl * control)
+	{
+		if (control)
+		{
+			control->rowsDone(1);
+		}
+	}
+
+	// where the time a stage takes is added, null when it isn't being timed
+	inline StageTimings * stageTimings(const GenerationControl * control)
+	{
+		return control ? control->stageTimings() : nullptr;
+	}
+
+	// which row border says is at y, for the rows just above the top & below the bottom. -1 when it's all 0
+	inline int borderRow(int y, int height, BorderMode border)
+	{
+		if (y >= 0 && y < height)
+		{
+			return y;
+		}
+
+		switch (border)
+		{
+		case BorderMode::Clamp:
+			return y < 0 ? 0 : height - 1;
+		case BorderMode::Wrap:
+			return y < 0 ? height - 1 : 0;
+		default:
+			return -1;
+		}
+	}
+
+	void packGradientRows(const GradientField & gradients, const ImageView & output, const NormalMapSettings & settings, int firstRow, int lastRow)
+	{
+		for (int y = firstRow; y < lastRow && !isCancelled(settings.control); ++y)
+		{
+			Kernels::packGradientRow(gradients.dxRow(y), gradients.dyRow(y), gradients.width(), settings.amplitude, settings.fastNormalise, output.row(y));
+			rowDone(settings.control);
+		}
+	}
+
+	// generates rows firstRow to lastRow - 1, each source row is converted to heights once by readHeights(y, heights) & the
+	// three rows the stencil needs are kept in a small rolling window so everything is read in memory order
+	template <typename HeightReader>
+	void normalMapRows(HeightReader readHeights, int width, int height, const ImageView & output, const NormalMapSettings & settings, int firstRow, int lastRow)
+	{
+		if (width <= 0 || firstRow >= lastRow)
+		{
+			return;
+		}
+
+		// every row has a height either side of it for the border, so the kernel never has to check for the edges
+		const size_t paddedWidth = static_cast<size_t>(width) + 2;
+		const std::vector<float> zeroStorage(paddedWidth, 0.0f);
+		const float * zeroRow = zeroStorage.data() + 1;
+		std::vector<float> rowStorage(paddedWidth * 3);
+
+		// rows[0] is the row above the one being generated, rows[1] the row itself & rows[2] the one below
+		float * rows[3] = { rowStorage.data() + 1, rowStorage.data() + paddedWidth + 1, rowStorage.data() + paddedWidth * 2 + 1 };
+
+		// reads row y (or the one the border puts there) into row, zeroRow if it's past the edge with a zero border
+		auto loadRow = [&](int y, float * row) -> const float *
+		{
+			const int sourceRow = borderRow(y, height, settings.border);
+			if (sourceRow < 0)
+			{
+				return zeroRow;
+			}
+
+			readHeights(sourceRow, row);
+			Kernels::padRow(row, width, settings.border);
+			return row;
+		};
+
+		const float * up = loadRow(firstRow - 1, rows[0]);
+		loadRow(firstRow, rows[1]);
+
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			if (isCancelled(settings.control))
+			{
+				return;
+			}
+
+			const float * down = loadRow(y + 1, rows[2]);
+
+			Kernels::normalMapRow(up, rows[1], down, width, settings.stencil, settings.amplitude, settings.fastNormalise, output.row(y));
+
+			// slide the window down a row, the old top row gets reused for the next row down
+			float * oldUp = rows[0];
+			rows[0] = rows[1];
+			rows[1] = rows[2];
+			rows[2] = oldUp;
+			up = rows[0];
+
+			rowDone(settings.control);
+		}
+	}
+
+	void normalMapRows(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings, int firstRow, int lastRow)
+	{
+		normalMapRows([&input](int y, float * heights) { Kernels::heightRow(input.row(y), input.width, heights); },
+			input.width, input.height, output, settings, firstRow, lastRow);
+	}
+
+	// heights that are already floats are copied into the window as they are, it needs its own padded rows either way
+	void normalMapRows(const HeightField & heights, const ImageView & output, const NormalMapSettings & settings, int firstRow, int lastRow)
+	{
+		normalMapRows([&heights](int y, float * heightsOut) { std::copy(heights.row(y), heights.row(y) + heights.width(), heightsOut); },
+			heights.width(), heights.height(), output, settings, firstRow, lastRow);
+	}
+
+	void normalMapRows(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings, int firstRow, int lastRow)
+	{
+		normalMapRows([&heights](int y, float * heightsOut) { Kernels::rawHeightRow(heights, y, heightsOut); },
+			heights.width, heights.height, output, settings, firstRow, lastRow);
+	}
+
+	void differenceEdgeRows(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, int firstRow, int lastRow)
+	{
+		for (int y = firstRow; y < lastRow && !isCancelled(settings.control); ++y)
+		{
+			const Pixel * above = y > 0 ? input.row(y - 1) : nullptr;
+			Kernels::edgeMapRow(above, input.row(y), input.width, settings.sensitivity, settings.primaryColour, settings.edgeColour, output.row(y));
+			rowDone(settings.control);
+		}
+	}
+
+	// the Sobel gradients of rows firstRow to lastRow - 1, handed to rowGradients(y, gx, gy, magnitude) a row at a time.
+	// it's separable, so each row's across pass is done once & kept in a rolling window of three for the down pass.
+	// pixels past the edges repeat the edge ones, so the border of the image doesn't come out as an edge
+	template <typename RowGradients>
+	void sobelRows(const ConstImageView & input, const GenerationControl * control, int firstRow, int lastRow, RowGradients rowGradients)
+	{
+		const int width = input.width;
+		if (width <= 0 || firstRow >= lastRow)
+		{
+			return;
+		}
+
+		std::vector<int> intensityStorage(static_cast<size_t>(width) + 2);
+		int * intensity = intensityStorage.data() + 1;
+
+		std::vector<int> acrossStorage(static_cast<size_t>(width) * 6);
+		int * smoothed[3], * differences[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			smoothed[i] = acrossStorage.data() + static_cast<size_t>(width) * i;
+			differences[i] = acrossStorage.data() + static_cast<size_t>(width) * (i + 3);
+		}
+
+		std::vector<int> gx(width), gy(width), magnitude(width);
+
+		auto acrossPass = [&](int y, int window)
+		{
+			Kernels::intensityRow(input.row(std::min(std::max(y, 0), input.height - 1)), width, intensity);
+			intensity[-1] = intensity[0];
+			intensity[width] = intensity[width - 1];
+			Kernels::sobelRowPass(intensity, width, smoothed[window], differences[window]);
+		};
+
+		acrossPass(firstRow - 1, 0);
+		acrossPass(firstRow, 1);
+
+		for (int y = firstRow; y < lastRow && !isCancelled(control); ++y)
+		{
+			acrossPass(y + 1, 2);
+			Kernels::sobelColumnPass(smoothed[0], smoothed[2], differences[0], differences[1], differences[2], width, gx.data(), gy.data(), magnitude.data());
+			rowGradients(y, gx.data(), gy.data(), magnitude.data());
+
+			// slide the window down a row
+			std::rotate(smoothed, smoothed + 1, smoothed + 3);
+			std::rotate(differences, differences + 1, differences + 3);
+		}
+	}
+
+	// a step of n gives a Sobel magnitude of 4n, so this keeps the sensitivity meaning the same as the difference detector's
+	inline int sobelThreshold(int sensitivity)
+	{
+		return sensitivity * 4;
+	}
+
+	void sobelEdgeRows(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, int firstRow, int lastRow)
+	{
+		sobelRows(input, settings.control, firstRow, lastRow, [&](int y, const int *, const int *, const int * magnitude)
+		{
+			Kernels::thresholdRow(magnitude, input.width, sobelThreshold(settings.sensitivity), settings.primaryColour, settings.edgeColour, output.row(y));
+			rowDone(settings.control);
+		});
+	}
+
+	// the detectors that go a row at a time, Canny can't & has its own passes
+	void edgeMapRows(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, int firstRow, int lastRow)
+	{
+		if (settings.detector == EdgeDetector::Sobel)
+		{
+			sobelEdgeRows(input, output, settings, firstRow, lastRow);
+		}
+		else
+		{
+			differenceEdgeRows(input, output, settings, firstRow, lastRow);
+		}
+	}
+
+	// fewer & the rows either side every band reads start to add up
+	const int minRowsPerBand = 16;
+
+	// rows per parallelFor chunk, a few chunks per thread so uneven threads even out
+	int bandRows(int height, const ThreadPool & threadPool)
+	{
+		const int bandsPerThread = 4;
+		return std::max(minRowsPerBand, height / static_cast<int>(threadPool.threadCount() * bandsPerThread));
+	}
+
+	// rows(firstRow, lastRow) in bands across the pool, or all in one go without one
+	template <typename RowsFunction>
+	void forBands(int height, ThreadPool * threadPool, RowsFunction rows)
+	{
+		if (threadPool)
+		{
+			threadPool->parallelFor(height, bandRows(height, *threadPool), rows);
+		}
+		else
+		{
+			rows(0, height);
+		}
+	}
+
+	// rows(firstRow, lastRow) as a task per band of about bandPixels, an image no bigger than that is one task
+	template <typename RowsFunction>
+	std::vector<std::function<void()>> bandTasks(int width, int height, int bandPixels, RowsFunction rows)
+	{
+		const int rowsPerBand = std::max(minRowsPerBand, bandPixels / std::max(1, width));
+
+		std::vector<std::function<void()>> tasks;
+		for (int firstRow = 0; firstRow < height; firstRow += rowsPerBand)
+		{
+			const int lastRow = std::min(height, firstRow + rowsPerBand);
+			tasks.push_back([rows, firstRow, lastRow]() { rows(firstRow, lastRow); });
+		}
+		return tasks;
+	}
+
+	// Canny needs the gradients of the whole image before it can follow edges along, so it's done in passes over it. the
+	// gradients, thinning & output are split into bands across the pool, following the weak edges out from the strong
+	// ones is on one thread but only touches a byte per pixel. progress is counted by the gradient pass
+	bool cannyEdgeMap(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, ThreadPool * threadPool)
+	{
+		const int width = input.width;
+		const int height = input.height;
+		if (width <= 0 || height <= 0)
+		{
+			return true;
+		}
+
+		// both have a row & column of 0 all the way round, so nothing has to check for the edges of the image
+		const size_t stride = static_cast<size_t>(width) + 2;
+		// pooled, a batch of same sized textures keeps reusing the same two planes
+		const size_t planeSize = stride * (height + 2);
+		PooledBuffer magnitudeStorage = BufferPool::defaultPool().acquire(planeSize * sizeof(unsigned short));
+		PooledBuffer classStorage = BufferPool::defaultPool().acquire(planeSize);
+		unsigned short * const magnitudes = magnitudeStorage.as<unsigned short>();
+		unsigned char * const classes = classStorage.as<unsigned char>();
+		std::fill(magnitudes, magnitudes + planeSize, static_cast<unsigned short>(0));
+		std::fill(classes, classes + planeSize, Kernels::cannyNone);
+
+		auto magnitudeRow = [&](int y) { return magnitudes + stride * (y + 1) + 1; };
+		auto classRow = [&](int y) { return classes + stride * (y + 1) + 1; };
+
+		// each pass is timed on its own
+		StageTimings * const timings = stageTimings(settings.control);
+
+		{
+			StageTimer timer(timings, "canny_gradients");
+			forBands(height, threadPool, [&](int firstRow, int lastRow)
+			{
+				sobelRows(input, settings.control, firstRow, lastRow, [&](int y, const int * gx, const int * gy, const int * magnitude)
+				{
+					Kernels::cannyGradientRow(gx, gy, magnitude, width, magnitudeRow(y), classRow(y));
+					rowDone(settings.control);
+				});
+			});
+		}
+
+		if (isCancelled(settings.control))
+		{
+			return false;
+		}
+
+		const int high = sobelThreshold(settings.sensitivity);
+		{
+			StageTimer timer(timings, "canny_thin");
+			forBands(height, threadPool, [&](int firstRow, int lastRow)
+			{
+				for (int y = firstRow; y < lastRow; ++y)
+				{
+					Kernels::cannySuppressRow(magnitudeRow(y - 1), magnitudeRow(y), magnitudeRow(y + 1), width, high / 2, high, classRow(y));
+				}
+			});
+		}
+
+		// every strong pixel is an edge, & so is every weak one joined on to one of them through the 8 around each pixel
+		{
+			StageTimer timer(timings, "canny_hysteresis");
+			const std::ptrdiff_t rowStep = static_cast<std::ptrdiff_t>(stride);
+			const std::ptrdiff_t neighbours[8] = { -rowStep - 1, -rowStep, -rowStep + 1, -1, 1, rowStep - 1, rowStep, rowStep + 1 };
+			std::vector<size_t> toFollow(1024);
+			size_t following = 0;
+
+			for (size_t i = 0; i < planeSize; ++i)
+			{
+				if (classes[i] != Kernels::cannyStrong)
+				{
+					continue;
+				}
+
+				classes[i] = Kernels::cannyEdge;
+				toFollow[following++] = i;
+
+				while (following > 0)
+				{
+					const size_t at = toFollow[--following];
+					if (toFollow.size() < following + 8)
+					{
+						toFollow.resize(toFollow.size() * 2);
+					}
+
+					// every neighbour is written to the stack but only counted if it's followed, noisy images
+					// have too many short edges for an if to be predicted
+					for (std::ptrdiff_t offset : neighbours)
+					{
+						unsigned char & neighbour = classes[at + offset];
+						const bool follow = neighbour == Kernels::cannyWeak || neighbour == Kernels::cannyStrong;
+						neighbour = follow ? static_cast<unsigned char>(Kernels::cannyEdge) : neighbour;
+						toFollow[following] = at + offset;
+						following += follow;
+					}
+				}
+			}
+		}
+
+		{
+			StageTimer timer(timings, "canny_output");
+			forBands(height, threadPool, [&](int firstRow, int lastRow)
+			{
+				for (int y = firstRow; y < lastRow; ++y)
+				{
+					const unsigned char * rowClasses = classRow(y);
+					Pixel * out = output.row(y);
+					for (int x = 0; x < width; ++x)
+					{
+						out[x] = rowClasses[x] == Kernels::cannyEdge ? settings.edgeColour : settings.primaryColour;
+					}
+				}
+			});
+		}
+		return !isCancelled(settings.control);
+	}
+}
+
+bool MapGen::generateEdgeMap(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings)
+{
+	if (settings.detector == EdgeDetector::Canny)
+	{
+		return cannyEdgeMap(input, output, settings, nullptr);
+	}
+
+	StageTimer timer(stageTimings(settings.control), "edge_map");
+	edgeMapRows(input, output, settings, 0, input.height);
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateEdgeMap(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, ThreadPool & threadPool)
+{
+	if (settings.detector == EdgeDetector::Canny)
+	{
+		return cannyEdgeMap(input, output, settings, &threadPool);
+	}
+
+	StageTimer timer(stageTimings(settings.control), "edge_map");
+	threadPool.parallelFor(input.height, bandRows(input.height, threadPool), [&](int firstRow, int lastRow)
+	{
+		edgeMapRows(input, output, settings, firstRow, lastRow);
+	});
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	normalMapRows(input, output, settings, 0, input.height);
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	// every band reads the row above & below it straight from the input, so bands don't depend on each other
+	threadPool.parallelFor(input.height, bandRows(input.height, threadPool), [&](int firstRow, int lastRow)
+	{
+		normalMapRows(input, output, settings, firstRow, lastRow);
+	});
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const HeightField & heights, const ImageView & output, const NormalMapSettings & settings)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	normalMapRows(heights, output, settings, 0, heights.height());
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const HeightField & heights, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	threadPool.parallelFor(heights.height(), bandRows(heights.height(), threadPool), [&](int firstRow, int lastRow)
+	{
+		normalMapRows(heights, output, settings, firstRow, lastRow);
+	});
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	normalMapRows(heights, output, settings, 0, heights.height);
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	threadPool.parallelFor(heights.height, bandRows(heights.height, threadPool), [&](int firstRow, int lastRow)
+	{
+		normalMapRows(heights, output, settings, firstRow, lastRow);
+	});
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const GradientField & gradients, const ImageView & output, const NormalMapSettings & settings)
+{
+	StageTimer timer(stageTimings(settings.control), "pack");
+	packGradientRows(gradients, output, settings, 0, gradients.height());
+	return !isCancelled(settings.control);
+}
+
+bool MapGen::generateNormalMap(const GradientField & gradients, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool)
+{
+	StageTimer timer(stageTimings(settings.control), "pack");
+	threadPool.parallelFor(gradients.height(), bandRows(gradients.height(), threadPool), [&](int firstRow, int lastRow)
+	{
+		packGradientRows(gradients, output, settings, firstRow, lastRow);
+	});
+	return !isCancelled(settings.control);
+}
+
+std::vector<std::function<void()>> MapGen::normalMapTasks(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings, int bandPixels)
+{
+	return bandTasks(input.width, input.height, bandPixels, [input, output, settings](int firstRow, int lastRow)
+	{
+		normalMapRows(input, output, settings, firstRow, lastRow);
+	});
+}
+
+std::vector<std::function<void()>> MapGen::normalMapTasks(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings, int bandPixels)
+{
+	return bandTasks(heights.width, heights.height, bandPixels, [heights, output, settings](int firstRow, int lastRow)
+	{
+		normalMapRows(heights, output, settings, firstRow, lastRow);
+	});
+}
+
+std::vector<std::function<void()>> MapGen::edgeMapTasks(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, int bandPixels)
+{
+	if (settings.detector == EdgeDetector::Canny)
+	{
+		return std::vector<std::function<void()>>(1, [input, output, settings]()
+		{
+			cannyEdgeMap(input, output, settings, nullptr);
+		});
+	}
+
+	return bandTasks(input.width, input.height, bandPixels, [input, output, settings](int firstRow, int lastRow)
+	{
+		edgeMapRows(input, output, settings, firstRow, lastRow);
+	});
+}
+
+bool MapGen::generateNormalMap(HeightRowSource & input, PixelRowSink & output, const NormalMapSettings & settings)
+{
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	const int width = input.width();
+	const int height = input.height();
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	// wrapping needs the last row before the first can be finished, which a stream can't give
+	if (settings.border == BorderMode::Wrap)
+	{
+		return false;
+	}
+
+	const size_t paddedWidth = static_cast<size_t>(width) + 2;
+	const std::vector<float> zeroStorage(paddedWidth, 0.0f);
+	std::vector<float> rowStorage(paddedWidth * 3);
+	std::vector<Pixel> outputRow(width);
+
+	// same padded rolling window as normalMapRows, except every row has to be read in order as the window reaches it
+	float * rows[3] = { rowStorage.data() + 1, rowStorage.data() + paddedWidth + 1, rowStorage.data() + paddedWidth * 2 + 1 };
+	if (!input.readRow(rows[1]))
+	{
+		return false;
+	}
+	Kernels::padRow(rows[1], width, settings.border);
+
+	for (int y = 0; y < height; ++y)
+	{
+		if (isCancelled(settings.control))
+		{
+			return false;
+		}
+
+		const bool haveDown = y + 1 < height;
+		if (haveDown)
+		{
+			if (!input.readRow(rows[2]))
+			{
+				return false;
+			}
+			Kernels::padRow(rows[2], width, settings.border);
+		}
+
+		// past the top & bottom it's either 0 or the edge row again
+		const float * outside = settings.border == BorderMode::Clamp ? rows[1] : zeroStorage.data() + 1;
+		Kernels::normalMapRow(y > 0 ? rows[0] : outside, rows[1], haveDown ? rows[2] : outside, width,
+			settings.stencil, settings.amplitude, settings.fastNormalise, outputRow.data());
+
+		if (!output.writeRow(outputRow.data()))
+		{
+			return false;
+		}
+
+		float * oldUp = rows[0];
+		rows[0] = rows[1];
+		rows[1] = rows[2];
+		rows[2] = oldUp;
+
+		rowDone(settings.control);
+	}
+	return true;
+}
+
+int MapGen::mipLevelCount(int width, int height)
+{
+	int levels = 1;
+	while (width > 1 || height > 1)
+	{
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		++levels;
+	}
+	return levels;
+}
+
+int MapGen::mipLevelSize(int fullSize, int level)
+{
+	return std::max(1, fullSize >> level);
+}
+
+bool MapGen::generateNormalMapMips(const HeightField & heights, const std::vector<ImageView> & outputs, const NormalMapSettings & settings, ThreadPool & threadPool)
+{
+	const int levelCount = static_cast<int>(outputs.size());
+
+	// the heights of every level after the first, each averaged down from the one before
+	std::vector<HeightField> smallerHeights(std::max(0, levelCount - 1));
+	for (int level = 1; level < levelCount; ++level)
+	{
+		const HeightField & larger = level == 1 ? heights : smallerHeights[level - 2];
+		if (!smallerHeights[level - 1].buildHalfSize(larger, &threadPool, settings.control))
+		{
+			return false;
+		}
+	}
+
+	auto levelHeights = [&](int level) -> const HeightField & { return level == 0 ? heights : smallerHeights[level - 1]; };
+
+	struct Band
+	{
+		int level, firstRow, lastRow;
+	};
+
+	// bands of every level go in one list, biggest level first, so the small levels fill in
+	// the gaps at the end rather than each level waiting for the one before to finish
+	std::vector<Band> bands;
+	for (int level = 0; level < levelCount; ++level)
+	{
+		const HeightField & levelHeight = levelHeights(level);
+		if (outputs[level].width != levelHeight.width() || outputs[level].height != levelHeight.height())
+		{
+			return false;
+		}
+
+		const int rowsPerBand = bandRows(levelHeight.height(), threadPool);
+		for (int firstRow = 0; firstRow < levelHeight.height(); firstRow += rowsPerBand)
+		{
+			bands.push_back({ level, firstRow, std::min(levelHeight.height(), firstRow + rowsPerBand) });
+		}
+	}
+
+	StageTimer timer(stageTimings(settings.control), "normal_map");
+	threadPool.parallelFor(static_cast<int>(bands.size()), 1, [&](int first, int last)
+	{
+		for (int i = first; i < last; ++i)
+		{
+			const Band & band = bands[i];
+
+			// a level's pixels cover twice the distance of the one before, so the same slope gives twice the height difference
+			NormalMapSettings levelSettings = settings;
+			levelSettings.amplitude = std::ldexp(settings.amplitude, -band.level);
+
+			normalMapRows(levelHeights(band.level), outputs[band.level], levelSettings, band.firstRow, band.lastRow);
+		}
+	});
+	return !isCancelled(settings.control);
+}
+
+unsigned int MapGen::difference(const Pixel a, const Pixel b)
+{
+	return Kernels::colourDifference(a, b);
+}
+
+float MapGen::calcHeightMapPx(const Pixel in)
+{
+	return Kernels::heightOf(in);
+}
+
+MapGen::Pixel MapGen::vectorToPixel(const Vector3D & in)
+{
+	return Kernels::packNormal(in.x, in.y, in.z);
+}
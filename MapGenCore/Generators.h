@@ -0,0 +1,99 @@
+#ifndef _GENERATORS_H_
+#define _GENERATORS_H_
+
+#include "BorderMode.h"
+#include "GenerationControl.h"
+#include "GradientStencil.h"
+#include "GradientField.h"
+#include "HeightField.h"
+#include "ImageBuffer.h"
+#include "RawHeightMap.h"
+#include "RowStream.h"
+#include "ThreadPool.h"
+
+#include <MathTypes.h>
+
+#include <functional>
+#include <vector>
+
+namespace MapGen
+{
+	struct NormalMapSettings
+	{
+		float amplitude = 1.0f;
+		bool fastNormalise = false; // approximate reciprocal square root, quicker but not bit exact
+		BorderMode border = BorderMode::Zero; // what the heights past the edges are, Wrap for tiling textures
+		GradientStencil stencil = GradientStencil::CentralDifference; // how the slopes are worked out, the 3x3 ones smooth out noise
+		GenerationControl * control = nullptr; // optional progress & cancellation
+	};
+
+	// how the edge map finds edges
+	enum class EdgeDetector
+	{
+		Difference, // differs from the pixel to the left or above by more than the sensitivity, the quickest
+		Sobel, // the 3x3 Sobel gradient is steeper than the sensitivity, less noisy & finds edges at any angle the same
+		Canny // Sobel thinned to lines one pixel wide, edges down to half the sensitivity are kept where they join stronger ones
+	};
+
+	struct EdgeMapSettings
+	{
+		EdgeDetector detector = EdgeDetector::Difference;
+		int sensitivity = 50; // 0 - 765, how big a step in the summed RGB counts as an edge
+		Pixel primaryColour = 0xff000000;
+		Pixel edgeColour = 0xffffffff;
+		GenerationControl * control = nullptr; // optional progress & cancellation
+	};
+
+	// output must be the same size as the input, the two mustn't overlap.
+	// every generator returns false if it was cancelled through settings.control, leaving the output unfinished
+	bool generateNormalMap(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings);
+	bool generateEdgeMap(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings);
+
+	// same as above but split into bands of rows across the thread pool, the output is identical
+	bool generateNormalMap(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool);
+	bool generateEdgeMap(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, ThreadPool & threadPool);
+
+	// normal map from heights built earlier, gives the same output as generating from the image they were built from
+	bool generateNormalMap(const HeightField & heights, const ImageView & output, const NormalMapSettings & settings);
+	bool generateNormalMap(const HeightField & heights, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool);
+
+	// normal map from raw height samples, e.g. a RawHeightMap's view()
+	bool generateNormalMap(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings);
+	bool generateNormalMap(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool);
+
+	// normal map from gradients built earlier, only normalises & packs so it's the quickest way to try a new amplitude.
+	// the border & stencil the gradients were built with are used, settings.border & settings.stencil are ignored
+	bool generateNormalMap(const GradientField & gradients, const ImageView & output, const NormalMapSettings & settings);
+	bool generateNormalMap(const GradientField & gradients, const ImageView & output, const NormalMapSettings & settings, ThreadPool & threadPool);
+
+	// normal map streamed a row at a time, only three rows of heights & one output row are ever held so maps
+	// far bigger than memory can be generated. gives the same output as the other overloads, returns false if
+	// a row couldn't be read or written as well as when cancelled. BorderMode::Wrap can't be streamed & always fails
+	bool generateNormalMap(HeightRowSource & input, PixelRowSink & output, const NormalMapSettings & settings);
+
+	// the generation split into tasks that can run in any order on any thread, for scheduling the bands of one image alongside
+	// other work (a batch of images across a TaskScheduler etc.). each task is a band of whole rows about bandPixels in size,
+	// an image no bigger than that is one task, & once every task has run the output is the same as the overloads above give.
+	// Canny needs the whole image at once so it's always one task. the views & settings are copied into the tasks but the
+	// pixels they point at have to outlive them
+	std::vector<std::function<void()>> normalMapTasks(const ConstImageView & input, const ImageView & output, const NormalMapSettings & settings, int bandPixels);
+	std::vector<std::function<void()>> normalMapTasks(const RawHeightView & heights, const ImageView & output, const NormalMapSettings & settings, int bandPixels);
+	std::vector<std::function<void()>> edgeMapTasks(const ConstImageView & input, const ImageView & output, const EdgeMapSettings & settings, int bandPixels);
+
+	// number of levels in a full mip chain for a width x height map, down to 1x1
+	int mipLevelCount(int width, int height);
+	// width or height of mip level from the full size one, each level is half the size of the one before but at least 1
+	int mipLevelSize(int fullSize, int level);
+
+	// normal maps for a whole mip chain, outputs[0] is full size & outputs[n] mipLevelSize() of it. each level is generated
+	// from the heights averaged down from the base & renormalised, rather than averaging the level above's normals which
+	// leaves them too short. the amplitude is halved per level so the slopes stay the same across the chain. every level
+	// is split into bands across the pool together, level 0 is the same as the other generators give
+	bool generateNormalMapMips(const HeightField & heights, const std::vector<ImageView> & outputs, const NormalMapSettings & settings, ThreadPool & threadPool);
+
+	unsigned int difference(const Pixel a, const Pixel b);
+	float calcHeightMapPx(const Pixel in);
+	Pixel vectorToPixel(const Vector3D & in);
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include "GradientField.h"
+#include "NormalMapKernel.h"
+
+#include <algorithm>
+#include <vector>
+
+MapGen::GradientField::GradientField()
+	: m_width(0)
+	, m_height(0)
+	, m_border(BorderMode::Zero)
+	, m_stencil(GradientStencil::CentralDifference)
+{
+}
+
+bool MapGen::GradientField::build(const HeightField & heights, BorderMode border, GradientStencil stencil, ThreadPool * threadPool, GenerationControl * control)
+{
+	StageTimer timer(control ? control->stageTimings() : nullptr, "gradients");
+
+	m_width = heights.width();
+	m_height = heights.height();
+	m_border = border;
+	m_stencil = stencil;
+
+	// pooled like the heights, every row's written below
+	const size_t bytes = sizeof(float) * m_width * m_height;
+	if (m_dx.size() != bytes)
+	{
+		m_dx.reset();
+		m_dy.reset();
+		m_dx = BufferPool::defaultPool().acquire(bytes);
+		m_dy = BufferPool::defaultPool().acquire(bytes);
+	}
+
+	// rows above the top & below the bottom of the image, a zero border counts them as 0
+	const std::vector<float> zeroRow(m_width, 0.0f);
+
+	auto outsideRow = [this, &heights, &zeroRow](int edgeRow, int oppositeRow)
+	{
+		switch (m_border)
+		{
+		case BorderMode::Clamp:
+			return heights.row(edgeRow);
+		case BorderMode::Wrap:
+			return heights.row(oppositeRow);
+		default:
+			return zeroRow.data();
+		}
+	};
+
+	auto buildRows = [this, &heights, &outsideRow, control](int firstRow, int lastRow)
+	{
+		// the three rows are copied into the middle of padded ones so the kernel doesn't check for the edges
+		const size_t paddedWidth = static_cast<size_t>(m_width) + 2;
+		std::vector<float> rowStorage(paddedWidth * 3);
+		float * rows[3] = { rowStorage.data() + 1, rowStorage.data() + paddedWidth + 1, rowStorage.data() + paddedWidth * 2 + 1 };
+
+		auto padded = [this](const float * row, float * paddedRow)
+		{
+			std::copy(row, row + m_width, paddedRow);
+			Kernels::padRow(paddedRow, m_width, m_border);
+			return paddedRow;
+		};
+
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			if (control && control->isCancelled())
+			{
+				return;
+			}
+
+			const float * up = y > 0 ? heights.row(y - 1) : outsideRow(0, m_height - 1);
+			const float * down = y + 1 < m_height ? heights.row(y + 1) : outsideRow(m_height - 1, 0);
+			const size_t rowStart = static_cast<size_t>(m_width) * y;
+
+			Kernels::gradientRow(padded(up, rows[0]), padded(heights.row(y), rows[1]), padded(down, rows[2]), m_width, m_stencil,
+				m_dx.as<float>() + rowStart, m_dy.as<float>() + rowStart);
+
+			if (control)
+			{
+				control->rowsDone(1);
+			}
+		}
+	};
+
+	if (threadPool)
+	{
+		threadPool->parallelFor(m_height, 64, buildRows);
+	}
+	else
+	{
+		buildRows(0, m_height);
+	}
+
+	if (control && control->isCancelled())
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+void MapGen::GradientField::clear()
+{
+	m_width = 0;
+	m_height = 0;
+	m_dx.reset();
+	m_dy.reset();
+}
+
+bool MapGen::GradientField::isEmpty() const
+{
+	return m_dx.isEmpty();
+}
+
+int MapGen::GradientField::width() const
+{
+	return m_width;
+}
+
+int MapGen::GradientField::height() const
+{
+	return m_height;
+}
+
+MapGen::BorderMode MapGen::GradientField::border() const
+{
+	return m_border;
+}
+
+MapGen::GradientStencil MapGen::GradientField::stencil() const
+{
+	return m_stencil;
+}
+
+const float * MapGen::GradientField::dxRow(int y) const
+{
+	return m_dx.as<float>() + static_cast<size_t>(m_width) * y;
+}
+
+const float * MapGen::GradientField::dyRow(int y) const
+{
+	return m_dy.as<float>() + static_cast<size_t>(m_width) * y;
+}
@@ -0,0 +1,42 @@
+#ifndef _GRADIENT_FIELD_H_
+#define _GRADIENT_FIELD_H_
+
+#include "BorderMode.h"
+#include "BufferPool.h"
+#include "GradientStencil.h"
+#include "HeightField.h"
+#include "GenerationControl.h"
+#include "ThreadPool.h"
+
+namespace MapGen
+{
+	// height differences across (right - left) & down (up - down) every pixel of a height field. the amplitude
+	// only scales these, so keeping them turns an amplitude change into a single pass over the output
+	class GradientField
+	{
+	public:
+		GradientField();
+
+		// threadPool & control can be null, returns false & leaves the field empty if it was cancelled.
+		// border & stencil are the same as NormalMapSettings::border & NormalMapSettings::stencil
+		bool build(const HeightField & heights, BorderMode border, GradientStencil stencil, ThreadPool * threadPool, GenerationControl * control = nullptr);
+		void clear();
+
+		bool isEmpty() const;
+		int width() const;
+		int height() const;
+		BorderMode border() const;
+		GradientStencil stencil() const;
+
+		const float * dxRow(int y) const;
+		const float * dyRow(int y) const;
+
+	private:
+		int m_width, m_height;
+		BorderMode m_border;
+		GradientStencil m_stencil;
+		PooledBuffer m_dx, m_dy;
+	};
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _GRADIENT_STENCIL_H_
+#define _GRADIENT_STENCIL_H_
+
+namespace MapGen
+{
+	// how the slope at each pixel is worked out from the heights around it. the 3x3 ones also take in the rows (or columns)
+	// either side, which smooths noisy height maps without blurring them first. every stencil is scaled so a steady slope
+	// gives the same normal whichever one is used
+	enum class GradientStencil
+	{
+		CentralDifference, // right - left & up - down, the sharpest & how maps have always been generated
+		Sobel, // weighted 1 2 1
+		Scharr, // weighted 3 10 3, smooths like Sobel but the direction of the slope comes out more accurately
+		Prewitt // weighted evenly, smooths the most
+	};
+}
+
+#endif
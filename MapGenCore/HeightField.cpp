@@ -0,0 +1,110 @@
+#include "HeightField.h"
+#include "NormalMapKernel.h"
+
+#include <algorithm>
+
+MapGen::HeightField::HeightField()
+	: m_width(0)
+	, m_height(0)
+{
+}
+
+bool MapGen::HeightField::build(const ConstImageView & image, ThreadPool * threadPool, GenerationControl * control)
+{
+	return build(image.width, image.height, [&image](int y, float * row) { Kernels::heightRow(image.row(y), image.width, row); }, threadPool, control);
+}
+
+bool MapGen::HeightField::build(const RawHeightView & heights, ThreadPool * threadPool, GenerationControl * control)
+{
+	return build(heights.width, heights.height, [&heights](int y, float * row) { Kernels::rawHeightRow(heights, y, row); }, threadPool, control);
+}
+
+bool MapGen::HeightField::buildHalfSize(const HeightField & larger, ThreadPool * threadPool, GenerationControl * control)
+{
+	const int width = std::max(1, larger.width() / 2);
+	const int height = std::max(1, larger.height() / 2);
+
+	return build(width, height, [&larger, width](int y, float * row)
+	{
+		const float * above = larger.row(std::min(y * 2, larger.height() - 1));
+		const float * below = larger.row(std::min(y * 2 + 1, larger.height() - 1));
+		Kernels::halfSizeHeightRow(above, below, larger.width(), width, row);
+	}, threadPool, control);
+}
+
+bool MapGen::HeightField::build(int width, int height, const std::function<void(int y, float * row)> & heightRow, ThreadPool * threadPool, GenerationControl * control)
+{
+	StageTimer timer(control ? control->stageTimings() : nullptr, "heights");
+
+	m_width = width;
+	m_height = height;
+
+	// every row's written below, so a block reused as it is or from the pool needn't be cleared
+	const size_t bytes = sizeof(float) * m_width * m_height;
+	if (m_heights.size() != bytes)
+	{
+		m_heights.reset();
+		m_heights = BufferPool::defaultPool().acquire(bytes);
+	}
+
+	auto buildRows = [this, &heightRow, control](int firstRow, int lastRow)
+	{
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			if (control && control->isCancelled())
+			{
+				return;
+			}
+
+			heightRow(y, m_heights.as<float>() + static_cast<size_t>(m_width) * y);
+
+			if (control)
+			{
+				control->rowsDone(1);
+			}
+		}
+	};
+
+	if (threadPool)
+	{
+		threadPool->parallelFor(m_height, 64, buildRows);
+	}
+	else
+	{
+		buildRows(0, m_height);
+	}
+
+	if (control && control->isCancelled())
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+void MapGen::HeightField::clear()
+{
+	m_width = 0;
+	m_height = 0;
+	m_heights.reset();
+}
+
+bool MapGen::HeightField::isEmpty() const
+{
+	return m_heights.isEmpty();
+}
+
+int MapGen::HeightField::width() const
+{
+	return m_width;
+}
+
+int MapGen::HeightField::height() const
+{
+	return m_height;
+}
+
+const float * MapGen::HeightField::row(int y) const
+{
+	return m_heights.as<float>() + static_cast<size_t>(m_width) * y;
+}
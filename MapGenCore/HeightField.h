@@ -0,0 +1,45 @@
+#ifndef _HEIGHT_FIELD_H_
+#define _HEIGHT_FIELD_H_
+
+#include "BufferPool.h"
+#include "ImageBuffer.h"
+#include "GenerationControl.h"
+#include "RawHeightMap.h"
+#include "ThreadPool.h"
+
+#include <functional>
+
+namespace MapGen
+{
+	// the 0 - 1 height of every pixel of an image, worked out once & kept so the normal map
+	// can be regenerated with different settings without converting the image again. the plane comes
+	// from BufferPool::defaultPool() & goes back to it when the field's cleared or rebuilt a different size
+	class HeightField
+	{
+	public:
+		HeightField();
+
+		// threadPool & control can be null, returns false & leaves the field empty if it was cancelled
+		bool build(const ConstImageView & image, ThreadPool * threadPool, GenerationControl * control = nullptr);
+		bool build(const RawHeightView & heights, ThreadPool * threadPool, GenerationControl * control = nullptr);
+
+		// half the width & height of larger (at least 1), each height the average of the 2x2 it covers. for mip chains
+		bool buildHalfSize(const HeightField & larger, ThreadPool * threadPool, GenerationControl * control = nullptr);
+		void clear();
+
+		bool isEmpty() const;
+		int width() const;
+		int height() const;
+
+		const float * row(int y) const;
+
+	private:
+		// fills every row with heightRow(y, row)
+		bool build(int width, int height, const std::function<void(int y, float * row)> & heightRow, ThreadPool * threadPool, GenerationControl * control);
+
+		int m_width, m_height;
+		PooledBuffer m_heights;
+	};
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef _IMAGE_BUFFER_H_
+#define _IMAGE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MapGen
+{
+	// 32 bit pixel stored as 0xAARRGGBB, the same layout as QRgb / QImage::Format_ARGB32
+	typedef uint32_t Pixel;
+
+	inline int pixelRed(Pixel px) { return (px >> 16) & 0xff; }
+	inline int pixelGreen(Pixel px) { return (px >> 8) & 0xff; }
+	inline int pixelBlue(Pixel px) { return px & 0xff; }
+	inline int pixelAlpha(Pixel px) { return px >> 24; }
+
+	// opaque pixel, same as qRgb()
+	inline Pixel makePixel(int red, int green, int blue)
+	{
+		return 0xff000000u | ((red & 0xff) << 16) | ((green & 0xff) << 8) | (blue & 0xff);
+	}
+
+	// non owning view of a 32 bit image, stride is the number of bytes between the start of each row
+	struct ImageView
+	{
+		unsigned char * data;
+		int width, height;
+		size_t stride;
+
+		ImageView() : data(nullptr), width(0), height(0), stride(0) {}
+		ImageView(unsigned char * data, int width, int height, size_t stride)
+			: data(data), width(width), height(height), stride(stride) {}
+
+		Pixel * row(int y) const { return reinterpret_cast<Pixel *>(data + stride * y); }
+	};
+
+	struct ConstImageView
+	{
+		const unsigned char * data;
+		int width, height;
+		size_t stride;
+
+		ConstImageView() : data(nullptr), width(0), height(0), stride(0) {}
+		ConstImageView(const unsigned char * data, int width, int height, size_t stride)
+			: data(data), width(width), height(height), stride(stride) {}
+		ConstImageView(const ImageView & view)
+			: data(view.data), width(view.width), height(view.height), stride(view.stride) {}
+
+		const Pixel * row(int y) const { return reinterpret_cast<const Pixel *>(data + stride * y); }
+	};
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MapGen::MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+#if defined(_WIN32)
+	, m_file(nullptr)
+	, m_mapping(nullptr)
+#endif
+{
+}
+
+MapGen::MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MapGen::MappedFile::open(const std::string & path)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_file = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping)
+	{
+		close();
+		return false;
+	}
+
+	m_data = static_cast<const unsigned char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size <= 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	// the mapping keeps its own reference to the file, so the descriptor isn't needed after this
+	void * mapped = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// the generators read top to bottom, so let the kernel read ahead
+	madvise(mapped, static_cast<size_t>(fileInfo.st_size), MADV_SEQUENTIAL);
+
+	m_data = static_cast<const unsigned char *>(mapped);
+	m_size = static_cast<size_t>(fileInfo.st_size);
+#endif
+	return true;
+}
+
+void MapGen::MappedFile::close()
+{
+#if defined(_WIN32)
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file)
+	{
+		CloseHandle(m_file);
+		m_file = nullptr;
+	}
+#else
+	if (m_data)
+	{
+		munmap(const_cast<unsigned char *>(m_data), m_size);
+	}
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool MapGen::MappedFile::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+const unsigned char * MapGen::MappedFile::data() const
+{
+	return m_data;
+}
+
+size_t MapGen::MappedFile::size() const
+{
+	return m_size;
+}
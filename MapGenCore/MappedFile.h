@@ -0,0 +1,36 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace MapGen
+{
+	// read only memory mapping of a whole file, pages are only read from disk as they're touched
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile & operator=(const MappedFile &) = delete;
+
+		bool open(const std::string & path);
+		void close();
+
+		bool isOpen() const;
+		const unsigned char * data() const;
+		size_t size() const;
+
+	private:
+		const unsigned char * m_data;
+		size_t m_size;
+#if defined(_WIN32)
+		void * m_file;
+		void * m_mapping;
+#endif
+	};
+}
+
+#endif
@@ -0,0 +1,308 @@
+#include "NormalMapKernel.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace MapGen;
+
+	typedef Simd::Lanes Lanes;
+	typedef Lanes::Float Float;
+	typedef Lanes::Int Int;
+
+	// Lanes::count heights, same sums in the same order as Kernels::heightOf so the results match exactly
+	inline Float heights(const Pixel * in)
+	{
+		const Float scale = Lanes::set(1.0f / static_cast<float>(255 * 3));
+		const Int channelMask = Lanes::setInt(0xff);
+
+		const Int px = Lanes::loadPixels(in);
+		const Float red = Lanes::toFloat(Lanes::bitAnd(Lanes::shiftRight<16>(px), channelMask));
+		const Float green = Lanes::toFloat(Lanes::bitAnd(Lanes::shiftRight<8>(px), channelMask));
+		const Float blue = Lanes::toFloat(Lanes::bitAnd(px, channelMask));
+
+		return Lanes::add(Lanes::add(Lanes::mul(red, scale), Lanes::mul(green, scale)), Lanes::mul(blue, scale));
+	}
+
+	// Lanes::count normals from the height differences across (right - left) & down (up - down) each pixel.
+	// s = (1, 0, s.z) & t = (0, 1, t.z) so s x t = (-s.z, -t.z, 1) which then gets normalised & packed
+	// exactly like Math::VectorMath::unitVector followed by Kernels::packNormal
+	inline void packGradients(Float dx, Float dy, Float amplitude, bool fastNormalise, Pixel * out)
+	{
+		const Float zero = Lanes::set(0.0f);
+		const Float one = Lanes::set(1.0f);
+		const Float half = Lanes::set(0.5f);
+		const Float maxChannel = Lanes::set(255.0f);
+
+		const Float x = Lanes::sub(zero, Lanes::mul(amplitude, dx));
+		const Float y = Lanes::sub(zero, Lanes::mul(amplitude, dy));
+
+		const Float magnitudeSquared = Lanes::add(Lanes::add(Lanes::mul(x, x), Lanes::mul(y, y)), one);
+
+		Float unitScale;
+		if (fastNormalise)
+		{
+			// estimate plus one Newton-Raphson step, good to ~22 bits which is plenty for 8 bit output
+			const Float estimate = Lanes::rsqrt(magnitudeSquared);
+			const Float halfMagnitudeSquared = Lanes::mul(half, magnitudeSquared);
+			unitScale = Lanes::mul(estimate, Lanes::sub(Lanes::set(1.5f), Lanes::mul(halfMagnitudeSquared, Lanes::mul(estimate, estimate))));
+		}
+		else
+		{
+			unitScale = Lanes::div(one, Lanes::sqrt(magnitudeSquared));
+		}
+
+		const Int red = Lanes::truncate(Lanes::mul(Lanes::mul(Lanes::add(Lanes::mul(x, unitScale), one), half), maxChannel));
+		const Int green = Lanes::truncate(Lanes::mul(Lanes::mul(Lanes::add(Lanes::mul(y, unitScale), one), half), maxChannel));
+		const Int blue = Lanes::truncate(Lanes::mul(Lanes::mul(Lanes::add(unitScale, one), half), maxChannel));
+
+		const Int px = Lanes::bitOr(Lanes::bitOr(Lanes::setInt(static_cast<int>(0xff000000)), Lanes::shiftLeft<16>(red)),
+			Lanes::bitOr(Lanes::shiftLeft<8>(green), blue));
+		Lanes::storePixels(out, px);
+	}
+
+	// a 3x3 gradient stencil, the differences across (or down) the row itself count CentreWeight times & the ones
+	// either side OuterWeight times. dividing by the total keeps a steady slope the same size whatever the weights,
+	// & with no outer weight it's just the central difference. every stencil is its own instantiation, so the per
+	// pixel loops have nothing to choose between
+	template <int OuterWeight, int CentreWeight>
+	struct Stencil
+	{
+		// Lanes::count gradients at x, up, centre & down point at x in padded rows
+		static inline void gradients(const float * up, const float * centre, const float * down, Float & dx, Float & dy)
+		{
+			const Float across = Lanes::sub(Lanes::load(centre + 1), Lanes::load(centre - 1));
+			const Float vertical = Lanes::sub(Lanes::load(up), Lanes::load(down));
+
+			if (OuterWeight == 0)
+			{
+				dx = across;
+				dy = vertical;
+				return;
+			}
+
+			const Float outer = Lanes::set(static_cast<float>(OuterWeight));
+			const Float middle = Lanes::set(static_cast<float>(CentreWeight));
+			const Float scale = Lanes::set(1.0f / static_cast<float>(OuterWeight * 2 + CentreWeight));
+
+			const Float acrossOutside = Lanes::add(Lanes::sub(Lanes::load(up + 1), Lanes::load(up - 1)),
+				Lanes::sub(Lanes::load(down + 1), Lanes::load(down - 1)));
+			const Float verticalOutside = Lanes::add(Lanes::sub(Lanes::load(up - 1), Lanes::load(down - 1)),
+				Lanes::sub(Lanes::load(up + 1), Lanes::load(down + 1)));
+
+			dx = Lanes::mul(Lanes::add(Lanes::mul(outer, acrossOutside), Lanes::mul(middle, across)), scale);
+			dy = Lanes::mul(Lanes::add(Lanes::mul(outer, verticalOutside), Lanes::mul(middle, vertical)), scale);
+		}
+	};
+
+	typedef Stencil<0, 1> CentralDifference;
+	typedef Stencil<1, 2> Sobel;
+	typedef Stencil<3, 10> Scharr;
+	typedef Stencil<1, 1> Prewitt;
+
+	// the last few pixels of a row that don't fill a block, copied with their neighbours into blocks padded out
+	// with 0 so they go through exactly the same maths as the rest without reading past the end of the rows
+	struct TailBlock
+	{
+		float up[Lanes::count + 2], centre[Lanes::count + 2], down[Lanes::count + 2];
+
+		TailBlock(const float * upRow, const float * centreRow, const float * downRow, int first, int width)
+		{
+			const int copied = width - first + 2;
+			std::fill(std::copy(upRow + first - 1, upRow + first - 1 + copied, up), up + Lanes::count + 2, 0.0f);
+			std::fill(std::copy(centreRow + first - 1, centreRow + first - 1 + copied, centre), centre + Lanes::count + 2, 0.0f);
+			std::fill(std::copy(downRow + first - 1, downRow + first - 1 + copied, down), down + Lanes::count + 2, 0.0f);
+		}
+	};
+
+	template <typename RowStencil>
+	void normalMapRowWith(const float * up, const float * centre, const float * down, int width, float amplitude, bool fastNormalise, Pixel * out)
+	{
+		const Float amplitudeLanes = Lanes::set(amplitude);
+		Float dx, dy;
+
+		// the padding means the edge pixels' neighbours are where the loads expect them, straight from the row buffers
+		int x = 0;
+		for (; x + Lanes::count <= width; x += Lanes::count)
+		{
+			RowStencil::gradients(up + x, centre + x, down + x, dx, dy);
+			packGradients(dx, dy, amplitudeLanes, fastNormalise, out + x);
+		}
+
+		if (x < width)
+		{
+			const TailBlock tail(up, centre, down, x, width);
+			Pixel block[Lanes::count];
+
+			RowStencil::gradients(tail.up + 1, tail.centre + 1, tail.down + 1, dx, dy);
+			packGradients(dx, dy, amplitudeLanes, fastNormalise, block);
+			std::copy(block, block + (width - x), out + x);
+		}
+	}
+
+	template <typename RowStencil>
+	void gradientRowWith(const float * up, const float * centre, const float * down, int width, float * dxOut, float * dyOut)
+	{
+		Float dx, dy;
+
+		int x = 0;
+		for (; x + Lanes::count <= width; x += Lanes::count)
+		{
+			RowStencil::gradients(up + x, centre + x, down + x, dx, dy);
+			Lanes::store(dxOut + x, dx);
+			Lanes::store(dyOut + x, dy);
+		}
+
+		if (x < width)
+		{
+			const TailBlock tail(up, centre, down, x, width);
+			float dxBlock[Lanes::count], dyBlock[Lanes::count];
+
+			RowStencil::gradients(tail.up + 1, tail.centre + 1, tail.down + 1, dx, dy);
+			Lanes::store(dxBlock, dx);
+			Lanes::store(dyBlock, dy);
+			std::copy(dxBlock, dxBlock + (width - x), dxOut + x);
+			std::copy(dyBlock, dyBlock + (width - x), dyOut + x);
+		}
+	}
+}
+
+void MapGen::Kernels::heightRow(const Pixel * in, int width, float * heightsOut)
+{
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		Lanes::store(heightsOut + x, heights(in + x));
+	}
+
+	for (; x < width; ++x)
+	{
+		heightsOut[x] = heightOf(in[x]);
+	}
+}
+
+void MapGen::Kernels::rawHeightRow(const RawHeightView & heights, int y, float * heightsOut)
+{
+	const unsigned char * in = heights.row(y);
+	if (heights.format == RawHeightFormat::R32F)
+	{
+		std::copy(in, in + static_cast<size_t>(heights.width) * sizeof(float), reinterpret_cast<unsigned char *>(heightsOut));
+		return;
+	}
+
+	// put together byte by byte so it's little endian whatever the machine is, compilers still vectorise it
+	if (heights.format == RawHeightFormat::R16)
+	{
+		const float scale = 1.0f / 65535.0f;
+		for (int x = 0; x < heights.width; ++x)
+		{
+			heightsOut[x] = static_cast<float>(in[x * 2] | (in[x * 2 + 1] << 8)) * scale;
+		}
+		return;
+	}
+
+	// same sums in the same order as heightOf, just with 16 bit channels
+	const float scale = 1.0f / static_cast<float>(65535 * 3);
+	for (int x = 0; x < heights.width; ++x)
+	{
+		const unsigned char * px = in + x * 8;
+
+		float height = 0.0f;
+		height += static_cast<float>(px[0] | (px[1] << 8)) * scale;
+		height += static_cast<float>(px[2] | (px[3] << 8)) * scale;
+		height += static_cast<float>(px[4] | (px[5] << 8)) * scale;
+		heightsOut[x] = height;
+	}
+}
+
+void MapGen::Kernels::halfSizeHeightRow(const float * above, const float * below, int width, int halfWidth, float * heightsOut)
+{
+	for (int x = 0; x < halfWidth; ++x)
+	{
+		const int left = std::min(x * 2, width - 1);
+		const int right = std::min(x * 2 + 1, width - 1);
+		heightsOut[x] = ((above[left] + above[right]) + (below[left] + below[right])) * 0.25f;
+	}
+}
+
+void MapGen::Kernels::padRow(float * row, int width, BorderMode border)
+{
+	switch (border)
+	{
+	case BorderMode::Zero:
+		row[-1] = 0.0f;
+		row[width] = 0.0f;
+		break;
+	case BorderMode::Clamp:
+		row[-1] = row[0];
+		row[width] = row[width - 1];
+		break;
+	case BorderMode::Wrap:
+		row[-1] = row[width - 1];
+		row[width] = row[0];
+		break;
+	}
+}
+
+void MapGen::Kernels::normalMapRow(const float * up, const float * centre, const float * down, int width, GradientStencil stencil,
+	float amplitude, bool fastNormalise, Pixel * out)
+{
+	switch (stencil)
+	{
+	case GradientStencil::Sobel:
+		normalMapRowWith<Sobel>(up, centre, down, width, amplitude, fastNormalise, out);
+		break;
+	case GradientStencil::Scharr:
+		normalMapRowWith<Scharr>(up, centre, down, width, amplitude, fastNormalise, out);
+		break;
+	case GradientStencil::Prewitt:
+		normalMapRowWith<Prewitt>(up, centre, down, width, amplitude, fastNormalise, out);
+		break;
+	default:
+		normalMapRowWith<CentralDifference>(up, centre, down, width, amplitude, fastNormalise, out);
+		break;
+	}
+}
+
+void MapGen::Kernels::gradientRow(const float * up, const float * centre, const float * down, int width, GradientStencil stencil, float * dx, float * dy)
+{
+	switch (stencil)
+	{
+	case GradientStencil::Sobel:
+		gradientRowWith<Sobel>(up, centre, down, width, dx, dy);
+		break;
+	case GradientStencil::Scharr:
+		gradientRowWith<Scharr>(up, centre, down, width, dx, dy);
+		break;
+	case GradientStencil::Prewitt:
+		gradientRowWith<Prewitt>(up, centre, down, width, dx, dy);
+		break;
+	default:
+		gradientRowWith<CentralDifference>(up, centre, down, width, dx, dy);
+		break;
+	}
+}
+
+void MapGen::Kernels::packGradientRow(const float * dx, const float * dy, int width, float amplitude, bool fastNormalise, Pixel * out)
+{
+	const Float amplitudeLanes = Lanes::set(amplitude);
+
+	int x = 0;
+	for (; x + Lanes::count <= width; x += Lanes::count)
+	{
+		packGradients(Lanes::load(dx + x), Lanes::load(dy + x), amplitudeLanes, fastNormalise, out + x);
+	}
+
+	// pad the end of the row out to a full block so it goes through the same maths
+	if (x < width)
+	{
+		float dxBlock[Lanes::count] = {}, dyBlock[Lanes::count] = {};
+		Pixel block[Lanes::count];
+		std::copy(dx + x, dx + width, dxBlock);
+		std::copy(dy + x, dy + width, dyBlock);
+
+		packGradients(Lanes::load(dxBlock), Lanes::load(dyBlock), amplitudeLanes, fastNormalise, block);
+		std::copy(block, block + (width - x), out + x);
+	}
+}
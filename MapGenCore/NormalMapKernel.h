@@ -0,0 +1,62 @@
+#ifndef _NORMAL_MAP_KERNEL_H_
+#define _NORMAL_MAP_KERNEL_H_
+
+#include "BorderMode.h"
+#include "GradientStencil.h"
+#include "ImageBuffer.h"
+#include "RawHeightMap.h"
+
+#include <cmath>
+
+// row kernels shared by the normal map generators, not part of the public interface
+namespace MapGen
+{
+	namespace Kernels
+	{
+		inline float heightOf(const Pixel in)
+		{
+			const float scale = 1.0f / static_cast<float>(255 * 3);
+
+			float height = 0.0f;
+			height += static_cast<float>(pixelRed(in)) * scale;
+			height += static_cast<float>(pixelGreen(in)) * scale;
+			height += static_cast<float>(pixelBlue(in)) * scale;
+			return height;
+		}
+
+		// maps a unit vector from -1 - 1 to 0 - 255 per channel
+		inline Pixel packNormal(float x, float y, float z)
+		{
+			const int red = static_cast<int>(((x + 1.0f) / 2.0f) * 255.0f);
+			const int green = static_cast<int>(((y + 1.0f) / 2.0f) * 255.0f);
+			const int blue = static_cast<int>(((z + 1.0f) / 2.0f) * 255.0f);
+			return makePixel(red, green, blue);
+		}
+
+		// converts a row of pixels to heights in the range 0 - 1
+		void heightRow(const Pixel * in, int width, float * heights);
+
+		// row y of a raw height map as 0 - 1 heights (R32F is copied as it is)
+		void rawHeightRow(const RawHeightView & heights, int y, float * heightsOut);
+
+		// averages each 2x2 of two rows of heights into a row halfWidth long, columns past the end of the rows repeat the last one
+		void halfSizeHeightRow(const float * above, const float * below, int width, int halfWidth, float * heightsOut);
+
+		// sets the heights either side of a row, row[-1] & row[width], to what border says is past its left & right edges
+		void padRow(float * row, int width, BorderMode border);
+
+		// one output row from the heights of the rows above, on & below it. all three have to have been through padRow,
+		// so every pixel including the edges goes through the same loop without checking where it is. the stencil is
+		// picked once per row, each has its own copy of the loop.
+		// fastNormalise uses an approximate reciprocal square root, which can be out by one in the last bit of the output
+		void normalMapRow(const float * up, const float * centre, const float * down, int width, GradientStencil stencil,
+			float amplitude, bool fastNormalise, Pixel * out);
+
+		// the two halves of normalMapRow, the height differences across (dx) & down (dy) each pixel don't depend
+		// on the amplitude so they can be kept & packed again with a different one. the rows are padded the same way
+		void gradientRow(const float * up, const float * centre, const float * down, int width, GradientStencil stencil, float * dx, float * dy);
+		void packGradientRow(const float * dx, const float * dy, int width, float amplitude, bool fastNormalise, Pixel * out);
+	}
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "PngFile.h"
+
+#if defined(MAPGEN_HAVE_ZLIB)
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	using namespace MapGen;
+
+	// deflate can look back 32K, so that much of the chunk before primes each chunk
+	const size_t dictionarySize = 32768;
+
+	// roughly how much filtered data goes in each chunk, big enough that priming costs little
+	const size_t targetChunkBytes = 1 << 20;
+
+	struct CompressedChunk
+	{
+		std::vector<unsigned char> data;
+		uLong adler;
+		size_t filteredSize;
+		uLong crc;
+	};
+
+	void appendBigEndian(std::vector<unsigned char> & bytes, uint32_t word)
+	{
+		for (int shift = 24; shift >= 0; shift -= 8)
+		{
+			bytes.push_back(static_cast<unsigned char>(word >> shift));
+		}
+	}
+
+	// crc covers the type & data, so it can be worked out before the chunk's written
+	uLong chunkCrc(const char * type, const unsigned char * data, size_t size)
+	{
+		const uLong crc = crc32(0, reinterpret_cast<const Bytef *>(type), 4);
+		return size > 0 ? crc32(crc, data, static_cast<uInt>(size)) : crc;
+	}
+
+	bool writeChunk(std::FILE * file, const char * type, const unsigned char * data, size_t size, uLong crc)
+	{
+		std::vector<unsigned char> header;
+		appendBigEndian(header, static_cast<uint32_t>(size));
+		header.insert(header.end(), type, type + 4);
+
+		std::vector<unsigned char> footer;
+		appendBigEndian(footer, static_cast<uint32_t>(crc));
+
+		return std::fwrite(header.data(), 1, header.size(), file) == header.size()
+			&& (size == 0 || std::fwrite(data, 1, size, file) == size)
+			&& std::fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+	}
+
+	void toBytes(const Pixel * row, int width, bool alpha, unsigned char * out)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			*out++ = static_cast<unsigned char>(pixelRed(row[x]));
+			*out++ = static_cast<unsigned char>(pixelGreen(row[x]));
+			*out++ = static_cast<unsigned char>(pixelBlue(row[x]));
+			if (alpha)
+			{
+				*out++ = static_cast<unsigned char>(pixelAlpha(row[x]));
+			}
+		}
+	}
+
+	// rows firstRow to lastRow - 1 as PNG scanlines, each a filter type byte then the row. the up filter (difference from
+	// the row above) is cheap & suits smooth maps, stored files don't bother filtering
+	void filterRows(const ConstImageView & image, bool alpha, bool filter, int firstRow, int lastRow, std::vector<unsigned char> & out)
+	{
+		const size_t pixelBytes = static_cast<size_t>(image.width) * (alpha ? 4 : 3);
+		std::vector<unsigned char> above(pixelBytes, 0), current(pixelBytes);
+
+		if (filter && firstRow > 0)
+		{
+			toBytes(image.row(firstRow - 1), image.width, alpha, above.data());
+		}
+
+		out.resize((pixelBytes + 1) * (lastRow - firstRow));
+		unsigned char * scanline = out.data();
+
+		for (int y = firstRow; y < lastRow; ++y)
+		{
+			toBytes(image.row(y), image.width, alpha, current.data());
+
+			*scanline++ = filter ? 2 : 0;
+			for (size_t i = 0; i < pixelBytes; ++i)
+			{
+				scanline[i] = filter ? static_cast<unsigned char>(current[i] - above[i]) : current[i];
+			}
+			scanline += pixelBytes;
+
+			above.swap(current);
+		}
+	}
+
+	// raw deflate of one chunk, flushed to a byte boundary so the chunks can simply be joined, the last one finishes the stream
+	bool deflateChunk(const std::vector<unsigned char> & input, size_t dictionaryBytes, int compressionLevel, bool last, std::vector<unsigned char> & out)
+	{
+		z_stream stream = {};
+		if (deflateInit2(&stream, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			return false;
+		}
+
+		if (dictionaryBytes > 0)
+		{
+			deflateSetDictionary(&stream, input.data(), static_cast<uInt>(dictionaryBytes));
+		}
+
+		const size_t inputBytes = input.size() - dictionaryBytes;
+		out.resize(deflateBound(&stream, static_cast<uLong>(inputBytes)) + 16);
+
+		stream.next_in = const_cast<Bytef *>(input.data() + dictionaryBytes);
+		stream.avail_in = static_cast<uInt>(inputBytes);
+		stream.next_out = out.data();
+		stream.avail_out = static_cast<uInt>(out.size());
+
+		const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+		const bool done = last ? result == Z_STREAM_END : (result == Z_OK && stream.avail_in == 0);
+
+		out.resize(stream.total_out);
+		deflateEnd(&stream);
+		return done;
+	}
+}
+
+bool MapGen::pngWriterAvailable()
+{
+	return true;
+}
+
+bool MapGen::writePng(const std::string & path, const ConstImageView & image, bool alpha, int compressionLevel, ThreadPool & threadPool)
+{
+	if (image.width <= 0 || image.height <= 0 || compressionLevel < 0 || compressionLevel > 9)
+	{
+		return false;
+	}
+
+	const bool filter = compressionLevel > 0;
+	const size_t scanlineBytes = static_cast<size_t>(image.width) * (alpha ? 4 : 3) + 1;
+	const int rowsPerChunk = static_cast<int>(std::max<size_t>(1, targetChunkBytes / scanlineBytes));
+	const int dictionaryRows = filter ? static_cast<int>((dictionarySize + scanlineBytes - 1) / scanlineBytes) : 0;
+	const int chunkCount = (image.height + rowsPerChunk - 1) / rowsPerChunk;
+
+	std::vector<CompressedChunk> chunks(chunkCount);
+	std::vector<char> chunkFailed(chunkCount, 0);
+
+	threadPool.parallelFor(chunkCount, 1, [&](int firstChunk, int lastChunk)
+	{
+		std::vector<unsigned char> filtered;
+		for (int chunk = firstChunk; chunk < lastChunk; ++chunk)
+		{
+			const int firstRow = chunk * rowsPerChunk;
+			const int lastRow = std::min(image.height, firstRow + rowsPerChunk);
+
+			// the rows before this chunk are filtered again just to get the dictionary from them
+			const int firstDictionaryRow = std::max(0, firstRow - dictionaryRows);
+			filterRows(image, alpha, filter, firstDictionaryRow, lastRow, filtered);
+
+			const size_t dictionaryBytes = std::min(dictionarySize, (firstRow - firstDictionaryRow) * scanlineBytes);
+			const size_t skipped = (firstRow - firstDictionaryRow) * scanlineBytes - dictionaryBytes;
+			filtered.erase(filtered.begin(), filtered.begin() + skipped);
+
+			CompressedChunk & out = chunks[chunk];
+			out.filteredSize = filtered.size() - dictionaryBytes;
+			out.adler = adler32(adler32(0, nullptr, 0), filtered.data() + dictionaryBytes, static_cast<uInt>(out.filteredSize));
+
+			chunkFailed[chunk] = !deflateChunk(filtered, dictionaryBytes, compressionLevel, chunk == chunkCount - 1, out.data);
+			out.crc = chunkCrc("IDAT", out.data.data(), out.data.size());
+		}
+	});
+
+	if (std::find(chunkFailed.begin(), chunkFailed.end(), 1) != chunkFailed.end())
+	{
+		return false;
+	}
+
+	std::FILE * file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	bool written = std::fwrite(signature, 1, sizeof(signature), file) == sizeof(signature);
+
+	std::vector<unsigned char> header;
+	appendBigEndian(header, static_cast<uint32_t>(image.width));
+	appendBigEndian(header, static_cast<uint32_t>(image.height));
+	header.push_back(8); // bits per channel
+	header.push_back(alpha ? 6 : 2); // RGBA or RGB
+	header.push_back(0); // deflate
+	header.push_back(0); // adaptive filtering
+	header.push_back(0); // not interlaced
+	written = written && writeChunk(file, "IHDR", header.data(), header.size(), chunkCrc("IHDR", header.data(), header.size()));
+
+	// the zlib stream is split over the IDATs, its header in the first, then the chunks as they are & the checksum of them all
+	const unsigned char zlibHeader[2] = { 0x78, 0x01 };
+	written = written && writeChunk(file, "IDAT", zlibHeader, 2, chunkCrc("IDAT", zlibHeader, 2));
+
+	uLong adler = adler32(0, nullptr, 0);
+	for (int chunk = 0; chunk < chunkCount && written; ++chunk)
+	{
+		written = writeChunk(file, "IDAT", chunks[chunk].data.data(), chunks[chunk].data.size(), chunks[chunk].crc);
+		adler = adler32_combine(adler, chunks[chunk].adler, static_cast<z_off_t>(chunks[chunk].filteredSize));
+	}
+
+	std::vector<unsigned char> checksum;
+	appendBigEndian(checksum, static_cast<uint32_t>(adler));
+	written = written && writeChunk(file, "IDAT", checksum.data(), checksum.size(), chunkCrc("IDAT", checksum.data(), checksum.size()));
+	written = written && writeChunk(file, "IEND", nullptr, 0, chunkCrc("IEND", nullptr, 0));
+
+	return std::fclose(file) == 0 && written;
+}
+
+#else
+
+bool MapGen::pngWriterAvailable()
+{
+	return false;
+}
+
+bool MapGen::writePng(const std::string &, const ConstImageView &, bool, int, ThreadPool &)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _PNG_FILE_H_
+#define _PNG_FILE_H_
+
+#include "ImageBuffer.h"
+#include "ThreadPool.h"
+
+#include <string>
+
+namespace MapGen
+{
+	// false when MapGenCore was built without zlib, writePng always fails then
+	bool pngWriterAvailable();
+
+	// writes an 8 bit RGB (or RGBA with alpha) PNG. the rows are split into chunks that are filtered & deflated on
+	// every thread of the pool at once, each primed with the end of the chunk before so hardly any compression is lost.
+	// compressionLevel is zlib's, 0 stores the pixels uncompressed (quickest, for intermediate files) up to 9 for the smallest
+	bool writePng(const std::string & path, const ConstImageView & image, bool alpha, int compressionLevel, ThreadPool & threadPool);
+}
+
+#endif
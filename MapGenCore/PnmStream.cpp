@@ -0,0 +1,196 @@
+#include "PnmStream.h"
+
+#include <cctype>
+
+MapGen::PnmHeightReader::PnmHeightReader()
+	: m_file(nullptr)
+	, m_width(0)
+	, m_height(0)
+	, m_channels(0)
+	, m_maxValue(0)
+{
+}
+
+MapGen::PnmHeightReader::~PnmHeightReader()
+{
+	close();
+}
+
+bool MapGen::PnmHeightReader::open(const std::string & path)
+{
+	close();
+
+	m_file = std::fopen(path.c_str(), "rb");
+	if (!m_file)
+	{
+		return false;
+	}
+
+	char magic[2] = {};
+	if (std::fread(magic, 1, 2, m_file) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6'))
+	{
+		close();
+		return false;
+	}
+	m_channels = magic[1] == '5' ? 1 : 3;
+
+	if (!readHeaderValue(m_width) || !readHeaderValue(m_height) || !readHeaderValue(m_maxValue)
+		|| m_width <= 0 || m_height <= 0 || m_maxValue <= 0 || m_maxValue > 65535)
+	{
+		close();
+		return false;
+	}
+
+	// anything over 255 is stored as 2 big endian bytes per channel
+	const int bytesPerChannel = m_maxValue > 255 ? 2 : 1;
+	m_rowBytes.resize(static_cast<size_t>(m_width) * m_channels * bytesPerChannel);
+	return true;
+}
+
+void MapGen::PnmHeightReader::close()
+{
+	if (m_file)
+	{
+		std::fclose(m_file);
+		m_file = nullptr;
+	}
+	m_width = 0;
+	m_height = 0;
+}
+
+int MapGen::PnmHeightReader::width() const
+{
+	return m_width;
+}
+
+int MapGen::PnmHeightReader::height() const
+{
+	return m_height;
+}
+
+bool MapGen::PnmHeightReader::readRow(float * heights)
+{
+	if (!m_file || std::fread(m_rowBytes.data(), 1, m_rowBytes.size(), m_file) != m_rowBytes.size())
+	{
+		return false;
+	}
+
+	// summed a channel at a time in the same order as Kernels::heightOf, a grey pixel counts as 3 equal channels
+	const float scale = 1.0f / static_cast<float>(m_maxValue * 3);
+	const bool wide = m_maxValue > 255;
+	const unsigned char * bytes = m_rowBytes.data();
+
+	for (int x = 0; x < m_width; ++x)
+	{
+		float channel[3] = {};
+		for (int c = 0; c < m_channels; ++c)
+		{
+			const int value = wide ? (bytes[0] << 8) | bytes[1] : bytes[0];
+			channel[c] = static_cast<float>(value);
+			bytes += wide ? 2 : 1;
+		}
+		if (m_channels == 1)
+		{
+			channel[1] = channel[0];
+			channel[2] = channel[0];
+		}
+
+		float height = 0.0f;
+		height += channel[0] * scale;
+		height += channel[1] * scale;
+		height += channel[2] * scale;
+		heights[x] = height;
+	}
+	return true;
+}
+
+// next number in the header, skipping whitespace & # comments. the single whitespace character
+// after the number is used up, which is what the format wants after the last header value
+bool MapGen::PnmHeightReader::readHeaderValue(int & value)
+{
+	int c = std::fgetc(m_file);
+	while (c != EOF && (std::isspace(c) || c == '#'))
+	{
+		if (c == '#')
+		{
+			while (c != EOF && c != '\n')
+			{
+				c = std::fgetc(m_file);
+			}
+		}
+		c = std::fgetc(m_file);
+	}
+
+	if (c == EOF || !std::isdigit(c))
+	{
+		return false;
+	}
+
+	value = 0;
+	while (c != EOF && std::isdigit(c))
+	{
+		if (value > (1 << 30) / 10)
+		{
+			return false;
+		}
+		value = value * 10 + (c - '0');
+		c = std::fgetc(m_file);
+	}
+	return c != EOF && std::isspace(c);
+}
+
+MapGen::PpmRowWriter::PpmRowWriter()
+	: m_file(nullptr)
+	, m_width(0)
+{
+}
+
+MapGen::PpmRowWriter::~PpmRowWriter()
+{
+	close();
+}
+
+bool MapGen::PpmRowWriter::open(const std::string & path, int width, int height)
+{
+	close();
+
+	m_file = std::fopen(path.c_str(), "wb");
+	if (!m_file)
+	{
+		return false;
+	}
+
+	m_width = width;
+	m_rowBytes.resize(static_cast<size_t>(width) * 3);
+	return std::fprintf(m_file, "P6\n%d %d\n255\n", width, height) > 0;
+}
+
+bool MapGen::PpmRowWriter::close()
+{
+	if (!m_file)
+	{
+		return false;
+	}
+
+	const bool ok = !std::ferror(m_file);
+	const bool closed = std::fclose(m_file) == 0;
+	m_file = nullptr;
+	return ok && closed;
+}
+
+bool MapGen::PpmRowWriter::writeRow(const Pixel * row)
+{
+	if (!m_file)
+	{
+		return false;
+	}
+
+	unsigned char * bytes = m_rowBytes.data();
+	for (int x = 0; x < m_width; ++x)
+	{
+		*bytes++ = static_cast<unsigned char>(pixelRed(row[x]));
+		*bytes++ = static_cast<unsigned char>(pixelGreen(row[x]));
+		*bytes++ = static_cast<unsigned char>(pixelBlue(row[x]));
+	}
+	return std::fwrite(m_rowBytes.data(), 1, m_rowBytes.size(), m_file) == m_rowBytes.size();
+}
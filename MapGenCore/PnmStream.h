@@ -0,0 +1,66 @@
+#ifndef _PNM_STREAM_H_
+#define _PNM_STREAM_H_
+
+#include "RowStream.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace MapGen
+{
+	// reads binary PGM (P5) & PPM (P6) files a row at a time, 8 or 16 bits per channel. they're the
+	// simplest formats that can be decoded a scanline at a time, so they're what the streaming mode takes
+	class PnmHeightReader : public HeightRowSource
+	{
+	public:
+		PnmHeightReader();
+		~PnmHeightReader();
+
+		PnmHeightReader(const PnmHeightReader &) = delete;
+		PnmHeightReader & operator=(const PnmHeightReader &) = delete;
+
+		// reads the header, leaving the file ready for the first row
+		bool open(const std::string & path);
+		void close();
+
+		int width() const override;
+		int height() const override;
+
+		// heights are the average of the channels, an 8 bit file gives exactly the same heights as Kernels::heightOf
+		bool readRow(float * heights) override;
+
+	private:
+		bool readHeaderValue(int & value);
+
+		std::FILE * m_file;
+		int m_width, m_height;
+		int m_channels, m_maxValue;
+		std::vector<unsigned char> m_rowBytes;
+	};
+
+	// writes a binary 8 bit PPM (P6) a row at a time, alpha is dropped
+	class PpmRowWriter : public PixelRowSink
+	{
+	public:
+		PpmRowWriter();
+		~PpmRowWriter();
+
+		PpmRowWriter(const PpmRowWriter &) = delete;
+		PpmRowWriter & operator=(const PpmRowWriter &) = delete;
+
+		bool open(const std::string & path, int width, int height);
+
+		// flushes everything to disk, returns false if anything failed to write
+		bool close();
+
+		bool writeRow(const Pixel * row) override;
+
+	private:
+		std::FILE * m_file;
+		int m_width;
+		std::vector<unsigned char> m_rowBytes;
+	};
+}
+
+#endif
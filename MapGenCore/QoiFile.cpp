@@ -0,0 +1,142 @@
+#include "QoiFile.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	// op codes from the QOI specification
+	const unsigned char opIndex = 0x00;
+	const unsigned char opDiff = 0x40;
+	const unsigned char opLuma = 0x80;
+	const unsigned char opRun = 0xc0;
+	const unsigned char opRgb = 0xfe;
+	const unsigned char opRgba = 0xff;
+
+	const int maxRun = 62;
+
+	inline int hashIndex(MapGen::Pixel px)
+	{
+		return (MapGen::pixelRed(px) * 3 + MapGen::pixelGreen(px) * 5 + MapGen::pixelBlue(px) * 7 + MapGen::pixelAlpha(px) * 11) % 64;
+	}
+
+	void appendBigEndian(std::vector<unsigned char> & bytes, uint32_t word)
+	{
+		for (int shift = 24; shift >= 0; shift -= 8)
+		{
+			bytes.push_back(static_cast<unsigned char>(word >> shift));
+		}
+	}
+}
+
+bool MapGen::writeQoi(const std::string & path, const ConstImageView & image, bool alpha)
+{
+	if (image.width <= 0 || image.height <= 0)
+	{
+		return false;
+	}
+
+	std::FILE * file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<unsigned char> bytes = { 'q', 'o', 'i', 'f' };
+	appendBigEndian(bytes, static_cast<uint32_t>(image.width));
+	appendBigEndian(bytes, static_cast<uint32_t>(image.height));
+	bytes.push_back(alpha ? 4 : 3);
+	bytes.push_back(0); // sRGB with linear alpha
+
+	Pixel seen[64] = {};
+	Pixel previous = 0xff000000;
+	int run = 0;
+	bool written = true;
+
+	// worst case is 5 bytes a pixel, written out a row at a time
+	bytes.reserve(static_cast<size_t>(image.width) * 5 + 16);
+
+	for (int y = 0; y < image.height && written; ++y)
+	{
+		const Pixel * row = image.row(y);
+		for (int x = 0; x < image.width; ++x)
+		{
+			const Pixel px = alpha ? row[x] : (row[x] | 0xff000000);
+
+			if (px == previous)
+			{
+				if (++run == maxRun)
+				{
+					bytes.push_back(static_cast<unsigned char>(opRun | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0)
+			{
+				bytes.push_back(static_cast<unsigned char>(opRun | (run - 1)));
+				run = 0;
+			}
+
+			const int index = hashIndex(px);
+			if (seen[index] == px)
+			{
+				bytes.push_back(static_cast<unsigned char>(opIndex | index));
+			}
+			else
+			{
+				seen[index] = px;
+
+				if (pixelAlpha(px) == pixelAlpha(previous))
+				{
+					// differences wrap around like unsigned bytes
+					const int red = static_cast<signed char>(pixelRed(px) - pixelRed(previous));
+					const int green = static_cast<signed char>(pixelGreen(px) - pixelGreen(previous));
+					const int blue = static_cast<signed char>(pixelBlue(px) - pixelBlue(previous));
+					const int redFromGreen = red - green;
+					const int blueFromGreen = blue - green;
+
+					if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+					{
+						bytes.push_back(static_cast<unsigned char>(opDiff | ((red + 2) << 4) | ((green + 2) << 2) | (blue + 2)));
+					}
+					else if (green >= -32 && green <= 31 && redFromGreen >= -8 && redFromGreen <= 7 && blueFromGreen >= -8 && blueFromGreen <= 7)
+					{
+						bytes.push_back(static_cast<unsigned char>(opLuma | (green + 32)));
+						bytes.push_back(static_cast<unsigned char>(((redFromGreen + 8) << 4) | (blueFromGreen + 8)));
+					}
+					else
+					{
+						bytes.push_back(opRgb);
+						bytes.push_back(static_cast<unsigned char>(pixelRed(px)));
+						bytes.push_back(static_cast<unsigned char>(pixelGreen(px)));
+						bytes.push_back(static_cast<unsigned char>(pixelBlue(px)));
+					}
+				}
+				else
+				{
+					bytes.push_back(opRgba);
+					bytes.push_back(static_cast<unsigned char>(pixelRed(px)));
+					bytes.push_back(static_cast<unsigned char>(pixelGreen(px)));
+					bytes.push_back(static_cast<unsigned char>(pixelBlue(px)));
+					bytes.push_back(static_cast<unsigned char>(pixelAlpha(px)));
+				}
+			}
+			previous = px;
+		}
+
+		written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		bytes.clear();
+	}
+
+	// a run left at the end, then the end marker
+	if (run > 0)
+	{
+		bytes.push_back(static_cast<unsigned char>(opRun | (run - 1)));
+	}
+	bytes.insert(bytes.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+	written = written && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+
+	return std::fclose(file) == 0 && written;
+}
@@ -0,0 +1,15 @@
+#ifndef _QOI_FILE_H_
+#define _QOI_FILE_H_
+
+#include "ImageBuffer.h"
+
+#include <string>
+
+namespace MapGen
+{
+	// writes a QOI (the "quite ok image" format), lossless & several times quicker to write than even a fast PNG.
+	// for intermediate files that get read back by other tools in the pipeline
+	bool writeQoi(const std::string & path, const ConstImageView & image, bool alpha);
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "RawHeightMap.h"
+#include "NormalMapKernel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+MapGen::RawHeightMap::RawHeightMap()
+{
+}
+
+bool MapGen::RawHeightMap::open(const std::string & path, RawHeightFormat format, int width, int height, size_t headerBytes)
+{
+	close();
+
+	// float rows are used in place, so they have to start on a float boundary
+	const size_t sampleBytes = static_cast<size_t>(bytesPerSample(format));
+	if (width < 0 || height < 0 || headerBytes % sampleBytes != 0 || !m_file.open(path) || m_file.size() <= headerBytes)
+	{
+		close();
+		return false;
+	}
+
+	const size_t samples = (m_file.size() - headerBytes) / sampleBytes;
+
+	// a size worked out from the file has to account for every byte of it, so a truncated or non square map fails
+	// rather than quietly losing its last row
+	const bool inferred = width == 0 || height == 0;
+	if (inferred && (m_file.size() - headerBytes) % sampleBytes != 0)
+	{
+		close();
+		return false;
+	}
+
+	if (width == 0 && height == 0)
+	{
+		width = static_cast<int>(std::sqrt(static_cast<double>(samples)) + 0.5);
+		height = width;
+	}
+	else if (width == 0)
+	{
+		width = static_cast<int>(samples / height);
+	}
+	else if (height == 0)
+	{
+		height = static_cast<int>(samples / width);
+	}
+
+	const size_t mapSamples = static_cast<size_t>(width) * height;
+	if (width <= 0 || height <= 0 || mapSamples > samples || (inferred && mapSamples != samples))
+	{
+		close();
+		return false;
+	}
+
+	m_view = RawHeightView(m_file.data() + headerBytes, width, height, width * sampleBytes, format);
+	return true;
+}
+
+void MapGen::RawHeightMap::close()
+{
+	m_file.close();
+	m_view = RawHeightView();
+}
+
+bool MapGen::RawHeightMap::isOpen() const
+{
+	return m_view.data != nullptr;
+}
+
+const MapGen::RawHeightView & MapGen::RawHeightMap::view() const
+{
+	return m_view;
+}
+
+int MapGen::RawHeightMap::bytesPerSample(RawHeightFormat format)
+{
+	switch (format)
+	{
+	case RawHeightFormat::R16:
+		return 2;
+	case RawHeightFormat::R32F:
+		return 4;
+	default:
+		return 8;
+	}
+}
+
+bool MapGen::RawHeightMap::formatFromFileName(const std::string & path, RawHeightFormat & format)
+{
+	const size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+	{
+		return false;
+	}
+
+	std::string extension = path.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == "r16" || extension == "raw")
+	{
+		format = RawHeightFormat::R16;
+		return true;
+	}
+	if (extension == "r32")
+	{
+		format = RawHeightFormat::R32F;
+		return true;
+	}
+	return false;
+}
+
+MapGen::RawHeightRowSource::RawHeightRowSource(const RawHeightView & view)
+	: m_view(view)
+	, m_nextRow(0)
+{
+}
+
+int MapGen::RawHeightRowSource::width() const
+{
+	return m_view.width;
+}
+
+int MapGen::RawHeightRowSource::height() const
+{
+	return m_view.height;
+}
+
+bool MapGen::RawHeightRowSource::readRow(float * heights)
+{
+	if (m_nextRow >= m_view.height)
+	{
+		return false;
+	}
+
+	Kernels::rawHeightRow(m_view, m_nextRow++, heights);
+	return true;
+}
@@ -0,0 +1,76 @@
+#ifndef _RAW_HEIGHT_MAP_H_
+#define _RAW_HEIGHT_MAP_H_
+
+#include "MappedFile.h"
+#include "RowStream.h"
+
+#include <string>
+
+namespace MapGen
+{
+	// headerless height samples as exported by terrain tools, little endian, top row first
+	enum class RawHeightFormat
+	{
+		R16,	// unsigned 16 bit, 0 - 65535 maps to 0 - 1
+		R32F,	// 32 bit float, used as it is
+		RGBA16	// four unsigned 16 bit channels (QImage::Format_RGBA64), the height is the average of red, green & blue
+	};
+
+	// non owning view of raw height samples, stride is the number of bytes between the start of each row.
+	// also used for 16 bit QImages (Format_Grayscale16 is R16) so they're read at their full precision
+	struct RawHeightView
+	{
+		const unsigned char * data;
+		int width, height;
+		size_t stride;
+		RawHeightFormat format;
+
+		RawHeightView() : data(nullptr), width(0), height(0), stride(0), format(RawHeightFormat::R16) {}
+		RawHeightView(const unsigned char * data, int width, int height, size_t stride, RawHeightFormat format)
+			: data(data), width(width), height(height), stride(stride), format(format) {}
+
+		const unsigned char * row(int y) const { return data + stride * y; }
+	};
+
+	// a raw height file mapped into memory, the generators read the samples straight out of the mapping
+	class RawHeightMap
+	{
+	public:
+		RawHeightMap();
+
+		// width & height of 0 work the size out from the file, a square map if both are 0. headerBytes are
+		// skipped at the start of the file. returns false if the file's too small for the size asked for, or if
+		// a size worked out from it doesn't use every sample exactly (not square, truncated, a partial sample)
+		bool open(const std::string & path, RawHeightFormat format, int width = 0, int height = 0, size_t headerBytes = 0);
+		void close();
+
+		bool isOpen() const;
+		const RawHeightView & view() const;
+
+		static int bytesPerSample(RawHeightFormat format);
+
+		// .r16 & .raw are R16, .r32 is R32F. returns false for anything else
+		static bool formatFromFileName(const std::string & path, RawHeightFormat & format);
+
+	private:
+		MappedFile m_file;
+		RawHeightView m_view;
+	};
+
+	// hands a raw height map to the streaming generator a row at a time
+	class RawHeightRowSource : public HeightRowSource
+	{
+	public:
+		explicit RawHeightRowSource(const RawHeightView & view);
+
+		int width() const override;
+		int height() const override;
+		bool readRow(float * heights) override;
+
+	private:
+		RawHeightView m_view;
+		int m_nextRow;
+	};
+}
+
+#endif
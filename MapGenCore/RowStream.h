@@ -0,0 +1,32 @@
+#ifndef _ROW_STREAM_H_
+#define _ROW_STREAM_H_
+
+#include "ImageBuffer.h"
+
+namespace MapGen
+{
+	// heights handed over a row at a time from the top down, for maps too big to hold in memory at once
+	class HeightRowSource
+	{
+	public:
+		virtual ~HeightRowSource() {}
+
+		virtual int width() const = 0;
+		virtual int height() const = 0;
+
+		// fills heights with the next row, 0 - 1. returns false if it couldn't be read
+		virtual bool readRow(float * heights) = 0;
+	};
+
+	// somewhere to put finished rows of pixels, top down, width() pixels each
+	class PixelRowSink
+	{
+	public:
+		virtual ~PixelRowSink() {}
+
+		// returns false if the row couldn't be written
+		virtual bool writeRow(const Pixel * row) = 0;
+	};
+}
+
+#endif
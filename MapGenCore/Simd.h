@@ -0,0 +1,169 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include "ImageBuffer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// picks the widest instruction set the compiler has been told it can use, AVX2 needs
+// MAPGEN_ENABLE_AVX2 turning on in CMake, SSE2 is always there on x64
+
+#if defined(__AVX2__)
+	#define MAPGEN_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MAPGEN_SSE2 1
+#endif
+
+#if defined(MAPGEN_AVX2)
+	#include <immintrin.h>
+#elif defined(MAPGEN_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace MapGen
+{
+	namespace Simd
+	{
+		// thin wrappers over the intrinsics so the kernels are written once for every instruction set.
+		// Float holds Lanes::count floats & Int the same number of 32 bit ints / pixels
+#if defined(MAPGEN_AVX2)
+		struct Lanes
+		{
+			typedef __m256 Float;
+			typedef __m256i Int;
+			enum { count = 8 };
+
+			static Float load(const float * p) { return _mm256_loadu_ps(p); }
+			static void store(float * p, Float v) { _mm256_storeu_ps(p, v); }
+			static Int loadPixels(const Pixel * p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+			static void storePixels(Pixel * p, Int v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+			static Int loadInts(const int * p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+			static void storeInts(int * p, Int v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+
+			static Float set(float v) { return _mm256_set1_ps(v); }
+			static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+			static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+			static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+			static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+			static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+			static Float rsqrt(Float a) { return _mm256_rsqrt_ps(a); }
+
+			static Int setInt(int v) { return _mm256_set1_epi32(v); }
+			static Int truncate(Float a) { return _mm256_cvttps_epi32(a); }
+			static Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+			static Int addInt(Int a, Int b) { return _mm256_add_epi32(a, b); }
+			static Int subInt(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+			static Int absInt(Int a) { return _mm256_abs_epi32(a); }
+			static Int bitAnd(Int a, Int b) { return _mm256_and_si256(a, b); }
+			static Int bitOr(Int a, Int b) { return _mm256_or_si256(a, b); }
+			static Int bitXor(Int a, Int b) { return _mm256_xor_si256(a, b); }
+			template <int bits> static Int shiftLeft(Int a) { return _mm256_slli_epi32(a, bits); }
+			template <int bits> static Int shiftRight(Int a) { return _mm256_srli_epi32(a, bits); }
+
+			// all bits set in the lanes where a > b
+			static Int greaterThan(Int a, Int b) { return _mm256_cmpgt_epi32(a, b); }
+			// a where mask is set, b where it isn't
+			static Int select(Int mask, Int a, Int b) { return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b)); }
+			// |a - b| of every byte
+			static Int absDiffBytes(Int a, Int b) { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+		};
+#elif defined(MAPGEN_SSE2)
+		struct Lanes
+		{
+			typedef __m128 Float;
+			typedef __m128i Int;
+			enum { count = 4 };
+
+			static Float load(const float * p) { return _mm_loadu_ps(p); }
+			static void store(float * p, Float v) { _mm_storeu_ps(p, v); }
+			static Int loadPixels(const Pixel * p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+			static void storePixels(Pixel * p, Int v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+			static Int loadInts(const int * p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+			static void storeInts(int * p, Int v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+
+			static Float set(float v) { return _mm_set1_ps(v); }
+			static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+			static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+			static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+			static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+			static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+			static Float rsqrt(Float a) { return _mm_rsqrt_ps(a); }
+
+			static Int setInt(int v) { return _mm_set1_epi32(v); }
+			static Int truncate(Float a) { return _mm_cvttps_epi32(a); }
+			static Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+			static Int addInt(Int a, Int b) { return _mm_add_epi32(a, b); }
+			static Int subInt(Int a, Int b) { return _mm_sub_epi32(a, b); }
+			// no abs until SSSE3, flip the negative lanes & add one
+			static Int absInt(Int a)
+			{
+				const Int sign = _mm_srai_epi32(a, 31);
+				return _mm_sub_epi32(_mm_xor_si128(a, sign), sign);
+			}
+			static Int bitAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+			static Int bitOr(Int a, Int b) { return _mm_or_si128(a, b); }
+			static Int bitXor(Int a, Int b) { return _mm_xor_si128(a, b); }
+			template <int bits> static Int shiftLeft(Int a) { return _mm_slli_epi32(a, bits); }
+			template <int bits> static Int shiftRight(Int a) { return _mm_srli_epi32(a, bits); }
+
+			static Int greaterThan(Int a, Int b) { return _mm_cmpgt_epi32(a, b); }
+			static Int select(Int mask, Int a, Int b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+			static Int absDiffBytes(Int a, Int b) { return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)); }
+		};
+#else
+		// no vector unit, one lane of plain floats
+		struct Lanes
+		{
+			typedef float Float;
+			typedef unsigned int Int;
+			enum { count = 1 };
+
+			static Float load(const float * p) { return *p; }
+			static void store(float * p, Float v) { *p = v; }
+			static Int loadPixels(const Pixel * p) { return *p; }
+			static void storePixels(Pixel * p, Int v) { *p = v; }
+			static Int loadInts(const int * p) { return static_cast<Int>(*p); }
+			static void storeInts(int * p, Int v) { *p = static_cast<int>(v); }
+
+			static Float set(float v) { return v; }
+			static Float add(Float a, Float b) { return a + b; }
+			static Float sub(Float a, Float b) { return a - b; }
+			static Float mul(Float a, Float b) { return a * b; }
+			static Float div(Float a, Float b) { return a / b; }
+			static Float sqrt(Float a) { return sqrtf(a); }
+			static Float rsqrt(Float a) { return 1.0f / sqrtf(a); }
+
+			static Int setInt(int v) { return static_cast<Int>(v); }
+			static Int truncate(Float a) { return static_cast<Int>(static_cast<int>(a)); }
+			static Float toFloat(Int a) { return static_cast<float>(static_cast<int>(a)); }
+			static Int addInt(Int a, Int b) { return a + b; }
+			static Int subInt(Int a, Int b) { return a - b; }
+			static Int absInt(Int a) { return static_cast<Int>(std::abs(static_cast<int>(a))); }
+			static Int bitAnd(Int a, Int b) { return a & b; }
+			static Int bitOr(Int a, Int b) { return a | b; }
+			static Int bitXor(Int a, Int b) { return a ^ b; }
+			template <int bits> static Int shiftLeft(Int a) { return a << bits; }
+			template <int bits> static Int shiftRight(Int a) { return a >> bits; }
+
+			static Int greaterThan(Int a, Int b) { return static_cast<int>(a) > static_cast<int>(b) ? ~0u : 0u; }
+			static Int select(Int mask, Int a, Int b) { return (mask & a) | (~mask & b); }
+			static Int absDiffBytes(Int a, Int b)
+			{
+				Int diff = 0;
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					const int byteA = (a >> shift) & 0xff;
+					const int byteB = (b >> shift) & 0xff;
+					diff |= static_cast<Int>(byteA > byteB ? byteA - byteB : byteB - byteA) << shift;
+				}
+				return diff;
+			}
+		};
+#endif
+	}
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include "StageTimings.h"
+
+#include <cstdio>
+
+void MapGen::StageTimings::add(const std::string & stage, double seconds)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (Stage & existing : m_stages)
+	{
+		if (existing.name == stage)
+		{
+			existing.seconds += seconds;
+			return;
+		}
+	}
+	m_stages.push_back(Stage{ stage, seconds });
+}
+
+void MapGen::StageTimings::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stages.clear();
+}
+
+std::vector<MapGen::StageTimings::Stage> MapGen::StageTimings::stages() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stages;
+}
+
+std::string MapGen::StageTimings::toJson() const
+{
+	std::string json = "{";
+	for (const Stage & stage : stages())
+	{
+		// the names are all ours, none need escaping
+		char seconds[32];
+		snprintf(seconds, sizeof(seconds), "%.6f", stage.seconds);
+		json += (json.size() > 1 ? ", \"" : "\"") + stage.name + "\": " + seconds;
+	}
+	return json + "}";
+}
+
+MapGen::StageTimer::StageTimer(StageTimings * timings, const char * stage)
+	: m_timings(timings)
+	, m_stage(stage)
+{
+	if (m_timings)
+	{
+		m_start = std::chrono::steady_clock::now();
+	}
+}
+
+MapGen::StageTimer::~StageTimer()
+{
+	if (m_timings)
+	{
+		m_timings->add(m_stage, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+	}
+}
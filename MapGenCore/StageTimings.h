@@ -0,0 +1,55 @@
+#ifndef _STAGE_TIMINGS_H_
+#define _STAGE_TIMINGS_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MapGen
+{
+	// wall clock seconds spent in each stage of a job (decoding, heights, gradients, packing, encoding etc.) in the order
+	// the stages first ran, for finding where the time goes. a stage that runs more than once, or in bands on several
+	// threads at a time, adds up so it can come to more than the job took
+	class StageTimings
+	{
+	public:
+		struct Stage
+		{
+			std::string name;
+			double seconds;
+		};
+
+		// thread safe
+		void add(const std::string & stage, double seconds);
+		void clear();
+
+		std::vector<Stage> stages() const;
+
+		// as a JSON object, {"decode": 0.012000, "heights": 0.003100 ...}
+		std::string toJson() const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::vector<Stage> m_stages;
+	};
+
+	// adds the time from when it's made to when it goes out of scope to a stage. does nothing when timings is null, so it
+	// can be left in paths that are only sometimes timed. it's two clock reads, cheap next to anything but per row work
+	class StageTimer
+	{
+	public:
+		StageTimer(StageTimings * timings, const char * stage);
+		~StageTimer();
+
+		StageTimer(const StageTimer &) = delete;
+		StageTimer & operator=(const StageTimer &) = delete;
+
+	private:
+		StageTimings * m_timings;
+		const char * m_stage;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
+
+#endif
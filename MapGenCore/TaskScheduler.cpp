@@ -0,0 +1,115 @@
+#include "TaskScheduler.h"
+
+namespace
+{
+	// the scheduler & queue of the task running on this thread, so tasks it adds go on the same queue
+	thread_local const MapGen::TaskScheduler * t_runningScheduler = nullptr;
+	thread_local int t_runningQueue = 0;
+}
+
+MapGen::TaskScheduler::TaskScheduler(ThreadPool & threadPool)
+	: m_threadPool(threadPool)
+	, m_unfinished(0)
+	, m_queued(0)
+	, m_nextQueue(0)
+{
+	for (unsigned int i = 0; i < threadPool.threadCount(); ++i)
+	{
+		m_queues.emplace_back(new Queue());
+	}
+}
+
+void MapGen::TaskScheduler::add(Task task)
+{
+	const int queueIndex = (t_runningScheduler == this) ? t_runningQueue : static_cast<int>(m_nextQueue++ % m_queues.size());
+
+	++m_unfinished;
+	{
+		Queue & queue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	++m_queued;
+
+	// taking the lock means a thread that's just checked m_queued can't miss this
+	{
+		std::lock_guard<std::mutex> lock(m_idleMutex);
+	}
+	m_idle.notify_one();
+}
+
+void MapGen::TaskScheduler::run()
+{
+	// a worker loop per queue, if the pool runs two on one thread the second just finds everything done
+	m_threadPool.parallelFor(static_cast<int>(m_queues.size()), 1, [this](int first, int last)
+	{
+		for (int queueIndex = first; queueIndex < last; ++queueIndex)
+		{
+			workerLoop(queueIndex);
+		}
+	});
+}
+
+void MapGen::TaskScheduler::workerLoop(int queueIndex)
+{
+	const TaskScheduler * const outerScheduler = t_runningScheduler;
+	const int outerQueue = t_runningQueue;
+	t_runningScheduler = this;
+	t_runningQueue = queueIndex;
+
+	Task task;
+	while (m_unfinished > 0)
+	{
+		if (takeTask(queueIndex, task))
+		{
+			task();
+			task = nullptr;
+
+			if (--m_unfinished == 0)
+			{
+				std::lock_guard<std::mutex> lock(m_idleMutex);
+				m_idle.notify_all();
+			}
+			continue;
+		}
+
+		// nothing to take but something's still running, & it might add more
+		std::unique_lock<std::mutex> lock(m_idleMutex);
+		m_idle.wait(lock, [this]() { return m_unfinished == 0 || m_queued > 0; });
+	}
+
+	t_runningScheduler = outerScheduler;
+	t_runningQueue = outerQueue;
+}
+
+bool MapGen::TaskScheduler::takeTask(int queueIndex, Task & task)
+{
+	// newest of our own first
+	{
+		Queue & queue = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			--m_queued;
+			return true;
+		}
+	}
+
+	// then the oldest of someone else's, starting from the next queue along so thieves spread out
+	const int queueCount = static_cast<int>(m_queues.size());
+	for (int i = 1; i < queueCount; ++i)
+	{
+		Queue & queue = *m_queues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			--m_queued;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,62 @@
+#ifndef _TASK_SCHEDULER_H_
+#define _TASK_SCHEDULER_H_
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace MapGen
+{
+	// runs a changing set of independent tasks across a thread pool until there are none left. each thread has its own queue
+	// & takes its next task from the back of it, a thread that runs out steals from the front of another's. tasks can add
+	// more tasks while they run, they go on the queue of the thread that added them so follow on work (the bands of an image
+	// that thread just loaded etc.) stays where its data is in cache, unless another thread has nothing else to do
+	class TaskScheduler
+	{
+	public:
+		typedef std::function<void()> Task;
+
+		explicit TaskScheduler(ThreadPool & threadPool);
+
+		TaskScheduler(const TaskScheduler &) = delete;
+		TaskScheduler & operator=(const TaskScheduler &) = delete;
+
+		// thread safe. before run() tasks are dealt out round the threads' queues in the order they're added, so the last
+		// ones added are the first each thread starts on. from inside a running task they go on the running thread's queue
+		void add(Task task);
+
+		// runs every task, including the ones added while running, & returns once they're all finished. the calling thread
+		// works on them too. tasks mustn't throw
+		void run();
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void workerLoop(int queueIndex);
+		bool takeTask(int queueIndex, Task & task);
+
+		ThreadPool & m_threadPool;
+		std::vector<std::unique_ptr<Queue>> m_queues;
+
+		// tasks added but not finished, & how many of those are still waiting in a queue
+		std::atomic<int> m_unfinished;
+		std::atomic<int> m_queued;
+		std::atomic<unsigned int> m_nextQueue;
+
+		// idle threads sleep on this until a task is added or the last one finishes
+		std::mutex m_idleMutex;
+		std::condition_variable m_idle;
+	};
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+MapGen::ThreadPool::ThreadPool(unsigned int threadCount)
+	: m_stopping(false)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// the thread calling parallelFor does a share of the work, so it counts as one of the threads
+	for (unsigned int i = 1; i < threadCount; ++i)
+	{
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+MapGen::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_taskAvailable.notify_all();
+
+	for (std::thread & worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int MapGen::ThreadPool::threadCount() const
+{
+	return static_cast<unsigned int>(m_workers.size()) + 1;
+}
+
+void MapGen::ThreadPool::parallelFor(int count, int chunkSize, const std::function<void(int first, int last)> & task)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	chunkSize = std::max(1, chunkSize);
+	const int chunkCount = (count + chunkSize - 1) / chunkSize;
+
+	if (chunkCount == 1 || m_workers.empty())
+	{
+		task(0, count);
+		return;
+	}
+
+	// shared so helpers that only get scheduled after everything is finished can still check it safely,
+	// they never touch task unless they managed to claim a chunk
+	struct ForState
+	{
+		std::atomic<int> nextChunk;
+		std::atomic<int> chunksDone;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	std::shared_ptr<ForState> state = std::make_shared<ForState>();
+	state->nextChunk = 0;
+	state->chunksDone = 0;
+
+	const std::function<void(int, int)> * taskPtr = &task;
+	auto runChunks = [state, taskPtr, count, chunkSize, chunkCount]()
+	{
+		int chunk;
+		while ((chunk = state->nextChunk++) < chunkCount)
+		{
+			const int first = chunk * chunkSize;
+			(*taskPtr)(first, std::min(count, first + chunkSize));
+
+			if (++state->chunksDone == chunkCount)
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->finished.notify_all();
+			}
+		}
+	};
+
+	const int helperCount = std::min(chunkCount - 1, static_cast<int>(m_workers.size()));
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (int i = 0; i < helperCount; ++i)
+		{
+			m_tasks.push_back(runChunks);
+		}
+	}
+	m_taskAvailable.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&state, chunkCount]() { return state->chunksDone == chunkCount; });
+}
+
+MapGen::ThreadPool & MapGen::ThreadPool::defaultPool()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void MapGen::ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+			if (m_stopping && m_tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
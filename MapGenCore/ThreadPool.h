@@ -0,0 +1,44 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MapGen
+{
+	class ThreadPool
+	{
+	public:
+		// 0 threads means one per hardware thread
+		explicit ThreadPool(unsigned int threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool & operator=(const ThreadPool &) = delete;
+
+		// number of threads that work on a parallelFor, including the calling thread
+		unsigned int threadCount() const;
+
+		// calls task(first, last) for consecutive ranges covering 0 - count, at most chunkSize long.
+		// the calling thread works on the ranges too & this only returns once every range is done
+		void parallelFor(int count, int chunkSize, const std::function<void(int first, int last)> & task);
+
+		// pool shared by everything that doesn't need its own, sized to the machine
+		static ThreadPool & defaultPool();
+
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_taskAvailable;
+		bool m_stopping;
+	};
+}
+
+#endif
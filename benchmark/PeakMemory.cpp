@@ -0,0 +1,31 @@
+#include "PeakMemory.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+long long peakMemoryKB()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+	#if defined(__APPLE__)
+		return usage.ru_maxrss / 1024; // bytes on macOS
+	#else
+		return usage.ru_maxrss;
+	#endif
+#endif
+}
@@ -0,0 +1,7 @@
+#ifndef _PEAK_MEMORY_H_
+#define _PEAK_MEMORY_H_
+
+// highest amount of physical memory the process has used so far, in kilobytes (0 if it can't be found)
+long long peakMemoryKB();
+
+#endif
@@ -0,0 +1,317 @@
+#include "PeakMemory.h"
+
+#include <Generators.h>
+#include <JoshMath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+// runs the generators over synthetic height fields & the hot Math::VectorMath functions, printing
+// one JSON object per result line so runs on different builds / machines can be compared
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		int minSize = 512;
+		int maxSize = 16384;
+		int repeats = 3;
+		unsigned int threads = 0; // 0 = every core
+		int vectorCount = 1 << 22;
+	};
+
+	// best of the repeats, in seconds
+	double timeBest(int repeats, const std::function<void()> & run)
+	{
+		double best = 0.0;
+		for (int i = 0; i < repeats; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			run();
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = (i == 0) ? seconds : std::min(best, seconds);
+		}
+		return best;
+	}
+
+	void reportPixels(const char * benchmark, int size, unsigned int threads, double seconds)
+	{
+		const double pixels = static_cast<double>(size) * size;
+		printf("{\"benchmark\": \"%s\", \"width\": %d, \"height\": %d, \"threads\": %u, \"seconds\": %.6f, "
+			"\"mpix_per_s\": %.2f, \"ns_per_pixel\": %.3f, \"peak_memory_kb\": %lld}\n",
+			benchmark, size, size, threads, seconds, pixels / seconds / 1.0e6, seconds * 1.0e9 / pixels, peakMemoryKB());
+		fflush(stdout);
+	}
+
+	void reportVectors(const char * benchmark, int count, double seconds)
+	{
+		printf("{\"benchmark\": \"%s\", \"vectors\": %d, \"threads\": 1, \"seconds\": %.6f, "
+			"\"mvec_per_s\": %.2f, \"ns_per_vector\": %.3f, \"peak_memory_kb\": %lld}\n",
+			benchmark, count, seconds, count / seconds / 1.0e6, seconds * 1.0e9 / count, peakMemoryKB());
+		fflush(stdout);
+	}
+
+	// rolling hills with a little noise on top, so there are gradients everywhere & some edges
+	void fillHeightMap(std::vector<MapGen::Pixel> & pixels, int size)
+	{
+		uint32_t noise = 12345;
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				noise = noise * 1664525u + 1013904223u;
+				const float hills = 0.5f + 0.25f * sinf(x * 0.013f) + 0.2f * cosf(y * 0.021f);
+				const int value = std::min(255, std::max(0, static_cast<int>(hills * 230.0f) + static_cast<int>(noise >> 28)));
+				pixels[static_cast<size_t>(y) * size + x] = MapGen::makePixel(value, value, value);
+			}
+		}
+	}
+
+	void benchmarkMaps(const BenchmarkOptions & options)
+	{
+		MapGen::ThreadPool threadPool(options.threads);
+		const unsigned int poolThreads = threadPool.threadCount();
+
+		for (int size = options.minSize; size <= options.maxSize; size *= 2)
+		{
+			const size_t stride = static_cast<size_t>(size) * sizeof(MapGen::Pixel);
+
+			std::vector<MapGen::Pixel> input(static_cast<size_t>(size) * size);
+			std::vector<MapGen::Pixel> output(input.size());
+			fillHeightMap(input, size);
+
+			const MapGen::ConstImageView inputView(reinterpret_cast<const unsigned char *>(input.data()), size, size, stride);
+			const MapGen::ImageView outputView(reinterpret_cast<unsigned char *>(output.data()), size, size, stride);
+
+			MapGen::NormalMapSettings normalSettings;
+			MapGen::EdgeMapSettings edgeSettings;
+
+			reportPixels("normal_map_serial", size, 1, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(inputView, outputView, normalSettings);
+			}));
+
+			reportPixels("normal_map", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(inputView, outputView, normalSettings, threadPool);
+			}));
+
+			MapGen::NormalMapSettings fastSettings;
+			fastSettings.fastNormalise = true;
+			reportPixels("normal_map_fast_normalise", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(inputView, outputView, fastSettings, threadPool);
+			}));
+
+			// the 3x3 stencils read three times as many heights per pixel
+			MapGen::NormalMapSettings sobelSettings;
+			sobelSettings.stencil = MapGen::GradientStencil::Sobel;
+			reportPixels("normal_map_sobel", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(inputView, outputView, sobelSettings, threadPool);
+			}));
+
+			reportPixels("edge_map_serial", size, 1, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateEdgeMap(inputView, outputView, edgeSettings);
+			}));
+
+			reportPixels("edge_map", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateEdgeMap(inputView, outputView, edgeSettings, threadPool);
+			}));
+
+			MapGen::EdgeMapSettings sobelEdgeSettings;
+			sobelEdgeSettings.detector = MapGen::EdgeDetector::Sobel;
+			reportPixels("edge_map_sobel", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateEdgeMap(inputView, outputView, sobelEdgeSettings, threadPool);
+			}));
+
+			MapGen::EdgeMapSettings cannySettings;
+			cannySettings.detector = MapGen::EdgeDetector::Canny;
+			reportPixels("edge_map_canny", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateEdgeMap(inputView, outputView, cannySettings, threadPool);
+			}));
+
+			// the cached paths the window uses when regenerating
+			MapGen::HeightField heights;
+			reportPixels("height_field_build", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				heights.build(inputView, &threadPool);
+			}));
+
+			MapGen::GradientField gradients;
+			reportPixels("gradient_field_build", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				gradients.build(heights, MapGen::BorderMode::Zero, MapGen::GradientStencil::CentralDifference, &threadPool);
+			}));
+
+			reportPixels("normal_map_from_heights", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(heights, outputView, normalSettings, threadPool);
+			}));
+
+			reportPixels("normal_map_from_gradients", size, poolThreads, timeBest(options.repeats, [&]()
+			{
+				MapGen::generateNormalMap(gradients, outputView, normalSettings, threadPool);
+			}));
+
+			if (size > options.maxSize / 2)
+			{
+				break; // stops size overflowing when maxSize isn't a power of two
+			}
+		}
+	}
+
+	// the per vector functions the generator used to call once per pixel, & the batched versions of them
+	void benchmarkVectorMath(const BenchmarkOptions & options)
+	{
+		const int count = options.vectorCount;
+		std::vector<Vector3D> a(count), b(count), result(count);
+		std::vector<float> dots(count);
+
+		for (int i = 0; i < count; ++i)
+		{
+			a[i].x = 1.0f;
+			a[i].y = 0.0f;
+			a[i].z = (i % 255) / 255.0f;
+			b[i].x = 0.0f;
+			b[i].y = 1.0f;
+			b[i].z = (i % 127) / 127.0f;
+		}
+
+		reportVectors("vector_math_cross_product", count, timeBest(options.repeats, [&]()
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				result[i] = Math::VectorMath::crossProduct(a[i], b[i]);
+			}
+		}));
+
+		reportVectors("vector_math_unit_vector", count, timeBest(options.repeats, [&]()
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				result[i] = Math::VectorMath::unitVector(a[i]);
+			}
+		}));
+
+		reportVectors("vector_math_dot_product", count, timeBest(options.repeats, [&]()
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				dots[i] = Math::VectorMath::dotProduct(a[i], b[i]);
+			}
+		}));
+
+		// the same again through the batched functions, with the vectors split into separate x, y & z arrays
+		std::vector<float> aX(count), aY(count), aZ(count), bX(count), bY(count), bZ(count), resultX(count), resultY(count), resultZ(count);
+		for (int i = 0; i < count; ++i)
+		{
+			aX[i] = a[i].x;
+			aY[i] = a[i].y;
+			aZ[i] = a[i].z;
+			bX[i] = b[i].x;
+			bY[i] = b[i].y;
+			bZ[i] = b[i].z;
+		}
+
+		const ConstVector3DSpan aSpan(aX.data(), aY.data(), aZ.data());
+		const ConstVector3DSpan bSpan(bX.data(), bY.data(), bZ.data());
+		const Vector3DSpan resultSpan(resultX.data(), resultY.data(), resultZ.data());
+
+		reportVectors("vector_math_cross_product_batched", count, timeBest(options.repeats, [&]()
+		{
+			Math::VectorMath::crossProduct(aSpan, bSpan, resultSpan, count);
+		}));
+
+		reportVectors("vector_math_unit_vector_batched", count, timeBest(options.repeats, [&]()
+		{
+			Math::VectorMath::unitVector(aSpan, resultSpan, count);
+		}));
+
+		reportVectors("vector_math_dot_product_batched", count, timeBest(options.repeats, [&]()
+		{
+			Math::VectorMath::dotProduct(aSpan, bSpan, dots.data(), count);
+		}));
+
+		// keeps the results alive so the loops can't be optimised away
+		volatile float sink = result[count / 2].z + dots[count / 3] + resultZ[count / 4];
+		(void)sink;
+	}
+
+	void printUsage()
+	{
+		printf("ImageMapGenBench [--min-size N] [--max-size N] [--repeats N] [--threads N] [--vectors N] [--skip-maps] [--skip-math]\n"
+			"  sizes are square & double from min to max (default 512 - 16384)\n"
+			"  threads 0 uses every core (default)\n");
+	}
+}
+
+int main(int argCount, char ** args)
+{
+	BenchmarkOptions options;
+	bool runMaps = true;
+	bool runMath = true;
+
+	for (int i = 1; i < argCount; ++i)
+	{
+		const std::string arg = args[i];
+		const bool hasValue = i + 1 < argCount;
+
+		if (arg == "--min-size" && hasValue)
+		{
+			options.minSize = std::max(1, atoi(args[++i]));
+		}
+		else if (arg == "--max-size" && hasValue)
+		{
+			options.maxSize = std::max(1, atoi(args[++i]));
+		}
+		else if (arg == "--repeats" && hasValue)
+		{
+			options.repeats = std::max(1, atoi(args[++i]));
+		}
+		else if (arg == "--threads" && hasValue)
+		{
+			options.threads = static_cast<unsigned int>(std::max(0, atoi(args[++i])));
+		}
+		else if (arg == "--vectors" && hasValue)
+		{
+			options.vectorCount = std::max(1, atoi(args[++i]));
+		}
+		else if (arg == "--skip-maps")
+		{
+			runMaps = false;
+		}
+		else if (arg == "--skip-math")
+		{
+			runMath = false;
+		}
+		else
+		{
+			printUsage();
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	if (runMaps)
+	{
+		benchmarkMaps(options);
+	}
+
+	if (runMath)
+	{
+		benchmarkVectorMath(options);
+	}
+
+	return 0;
+}
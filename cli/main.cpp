@@ -0,0 +1,930 @@
+#include "mapgenerators.h"
+#include "resultcache.h"
+
+#include <PnmStream.h>
+#include <RawHeightMap.h>
+#include <TaskScheduler.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// headless version of ImageMapGenExe, no widgets or display needed so it can run on the asset farm
+
+static int fail(const QString & message)
+{
+	QTextStream(stderr) << "ImageMapGenCli: " << message << endl;
+	return 1;
+}
+
+// the normal map options, shared by a single job & every job of a batch. error says what's wrong when it returns false
+static bool readNormalSettings(const QCommandLineParser & parser, MapGen::NormalMapSettings & settings, QString & error)
+{
+	bool validAmp = false;
+	settings.amplitude = parser.value("amplitude").toFloat(&validAmp);
+	if (!validAmp)
+	{
+		error = "invalid amplitude " + parser.value("amplitude");
+		return false;
+	}
+	settings.fastNormalise = parser.isSet("fast-normalise");
+
+	const QString borderMode = parser.value("border").toLower();
+	if (borderMode == "clamp")
+	{
+		settings.border = MapGen::BorderMode::Clamp;
+	}
+	else if (borderMode == "wrap")
+	{
+		settings.border = MapGen::BorderMode::Wrap;
+	}
+	else if (borderMode != "zero")
+	{
+		error = "unknown border mode " + borderMode + ", expected zero, clamp or wrap";
+		return false;
+	}
+
+	const QString stencil = parser.value("stencil").toLower();
+	if (stencil == "sobel")
+	{
+		settings.stencil = MapGen::GradientStencil::Sobel;
+	}
+	else if (stencil == "scharr")
+	{
+		settings.stencil = MapGen::GradientStencil::Scharr;
+	}
+	else if (stencil == "prewitt")
+	{
+		settings.stencil = MapGen::GradientStencil::Prewitt;
+	}
+	else if (stencil != "central")
+	{
+		error = "unknown stencil " + stencil + ", expected central, sobel, scharr or prewitt";
+		return false;
+	}
+	return true;
+}
+
+// the edge map options, same as above
+static bool readEdgeSettings(const QCommandLineParser & parser, MapGen::EdgeMapSettings & settings, QString & error)
+{
+	bool validSensitivity = false;
+	settings.sensitivity = parser.value("sensitivity").toInt(&validSensitivity);
+	if (!validSensitivity || settings.sensitivity < 0 || settings.sensitivity > 255 * 3)
+	{
+		error = "invalid sensitivity " + parser.value("sensitivity");
+		return false;
+	}
+
+	QColor primaryColour(parser.value("primary-colour"));
+	QColor edgeColour(parser.value("edge-colour"));
+	if (!primaryColour.isValid() || !edgeColour.isValid())
+	{
+		error = "invalid edge map colour";
+		return false;
+	}
+
+	settings.primaryColour = primaryColour.rgb();
+	settings.edgeColour = edgeColour.rgb();
+
+	const QString detector = parser.value("edge-detector").toLower();
+	if (detector == "sobel")
+	{
+		settings.detector = MapGen::EdgeDetector::Sobel;
+	}
+	else if (detector == "canny")
+	{
+		settings.detector = MapGen::EdgeDetector::Canny;
+	}
+	else if (detector != "difference")
+	{
+		error = "unknown edge detector " + detector + ", expected difference, sobel or canny";
+		return false;
+	}
+	return true;
+}
+
+static QString jsonString(QString text)
+{
+	return "\"" + text.replace('\\', "\\\\").replace('"', "\\\"") + "\"";
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// where --stats goes, - is stdout
+static bool openStats(QFile & file, const QString & fileName)
+{
+	if (fileName == "-")
+	{
+		return file.open(stdout, QIODevice::WriteOnly);
+	}
+
+	file.setFileName(fileName);
+	return file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+}
+
+// the --stats report of a single job, laid out like the lines a batch prints. returns main's exit code
+static int finishJob(const QCommandLineParser & parser, const MapGen::StageTimings & timings, std::chrono::steady_clock::time_point start,
+	int width, int height, bool cached)
+{
+	if (!parser.isSet("stats"))
+	{
+		return 0;
+	}
+
+	QFile stats;
+	if (!openStats(stats, parser.value("stats")))
+	{
+		return fail("couldn't write " + parser.value("stats"));
+	}
+
+	QTextStream(&stats) << "{\"input\": " << jsonString(parser.value("input")) << ", \"output\": " << jsonString(parser.value("output"))
+		<< ", \"type\": " << jsonString(parser.value("type").toLower()) << ", \"width\": " << width << ", \"height\": " << height
+		<< ", \"cached\": " << (cached ? "true" : "false") << ", \"stages\": " << QString::fromStdString(timings.toJson())
+		<< ", \"seconds\": " << QString::number(secondsSince(start), 'f', 6) << "}" << endl;
+	return 0;
+}
+
+// one image of a batch
+struct BatchJob
+{
+	QString input;
+	QString output;
+	bool edgeMap = false;
+	MapGen::NormalMapSettings normalSettings;
+	MapGen::EdgeMapSettings edgeSettings;
+	int compressionLevel = 6;
+	long long pixels = 0; // from the input's header, so the biggest can be started first
+};
+
+// a job while it's being worked on, shared by its bands so whichever finishes last saves it
+struct BatchJobState
+{
+	BatchJob job;
+	QImage input;
+	QImage output;
+	QByteArray cacheKey;
+	std::chrono::steady_clock::time_point start;
+	MapGen::StageTimings timings;
+	int bandCount = 0;
+	std::atomic<int> bandsLeft;
+};
+
+// shared by every task of a batch
+struct BatchContext
+{
+	MapGen::TaskScheduler * scheduler = nullptr;
+	MapGen::ThreadPool * savePool = nullptr;
+	const ResultCache * cache = nullptr; // null without --cache
+	QTextStream * report = nullptr; // where the JSON lines go, stdout or --stats
+	std::mutex reportMutex;
+	int failedJobs = 0;
+};
+
+// bands of about this many pixels are well under a millisecond each, small enough that the bands of one big map keep every
+// thread busy to the end of a batch & big enough that scheduling them doesn't show. smaller images are one task
+static const int batchBandPixels = 1 << 18;
+
+static void batchJobFailed(BatchContext & context, const QString & message)
+{
+	std::lock_guard<std::mutex> lock(context.reportMutex);
+	++context.failedJobs;
+	QTextStream(stderr) << "ImageMapGenCli: " << message << endl;
+}
+
+// one JSON object per line like the benchmark, with the time each stage took
+static void reportBatchJob(BatchContext & context, const BatchJobState & state, bool cached)
+{
+	const BatchJob & job = state.job;
+
+	std::lock_guard<std::mutex> lock(context.reportMutex);
+	*context.report << "{\"input\": " << jsonString(job.input) << ", \"output\": " << jsonString(job.output)
+		<< ", \"type\": \"" << (job.edgeMap ? "edge" : "normal") << "\", \"width\": " << state.input.width()
+		<< ", \"height\": " << state.input.height() << ", \"cached\": " << (cached ? "true" : "false")
+		<< ", \"bands\": " << state.bandCount << ", \"stages\": " << QString::fromStdString(state.timings.toJson())
+		<< ", \"seconds\": " << QString::number(secondsSince(state.start), 'f', 6) << "}" << endl;
+}
+
+// saves the generated map, adds it to the cache & reports the job's timing
+static void finishBatchJob(BatchContext & context, BatchJobState & state)
+{
+	const BatchJob & job = state.job;
+
+	bool saved;
+	{
+		MapGen::StageTimer timer(&state.timings, "encode");
+		saved = MapGenerators::saveImage(job.output, state.output, job.compressionLevel, *context.savePool);
+	}
+	if (!saved)
+	{
+		batchJobFailed(context, "couldn't write " + job.output);
+		return;
+	}
+
+	if (context.cache)
+	{
+		MapGen::StageTimer timer(&state.timings, "cache_store");
+		if (!context.cache->store(state.cacheKey, job.output))
+		{
+			std::lock_guard<std::mutex> lock(context.reportMutex);
+			QTextStream(stderr) << "ImageMapGenCli: couldn't add " << job.output << " to the cache" << endl;
+		}
+	}
+
+	reportBatchJob(context, state, false);
+}
+
+// loads a job's input & adds a task per band of it, the band that finishes last saves it. the generation stage is the
+// time spent in the bands added up, so it's the same however many threads shared them
+static void startBatchJob(BatchContext & context, const BatchJob & job)
+{
+	std::shared_ptr<BatchJobState> state = std::make_shared<BatchJobState>();
+	state->job = job;
+	state->start = std::chrono::steady_clock::now();
+
+	QImage image;
+	{
+		MapGen::StageTimer timer(&state->timings, "decode");
+		image = QImage(job.input);
+	}
+	if (image.isNull())
+	{
+		batchJobFailed(context, "couldn't load " + job.input);
+		return;
+	}
+
+	// converted before hashing like the single map path, so a job gets the same key either way & a palette image is
+	// keyed by its colours rather than its indices. 16 bit heights are used as they are
+	MapGen::RawHeightView heights;
+	const bool nativeHeights = !job.edgeMap && MapGenerators::heightView(image, heights);
+	if (nativeHeights)
+	{
+		state->input = image;
+	}
+	else
+	{
+		MapGen::StageTimer timer(&state->timings, "convert");
+		state->input = MapGenerators::toGeneratorFormat(image);
+	}
+
+	// copied out of the cache if it hasn't changed since it was last generated. the pixels are hashed on this thread,
+	// the others have jobs of their own
+	if (context.cache)
+	{
+		{
+			MapGen::StageTimer timer(&state->timings, "hash");
+			state->cacheKey = job.edgeMap ? ResultCache::edgeMapKey(state->input, job.edgeSettings, job.output, job.compressionLevel, *context.savePool)
+				: ResultCache::normalMapKey(state->input, job.normalSettings, job.output, job.compressionLevel, *context.savePool);
+		}
+
+		const auto copyStart = std::chrono::steady_clock::now();
+		if (context.cache->fetch(state->cacheKey, job.output))
+		{
+			state->timings.add("copy", secondsSince(copyStart));
+			reportBatchJob(context, *state, true);
+			return;
+		}
+	}
+
+	// pooled, so once the first few jobs have finished the rest of a batch of same sized textures reuse their planes
+	state->output = MapGenerators::pooledImage(image.width(), image.height());
+	const MapGen::ImageView outputView = MapGenerators::imageView(state->output);
+
+	// the same paths MapGenerators::generateNormalMap & generateEdgeMap take
+	std::vector<std::function<void()>> bands;
+	if (nativeHeights)
+	{
+		// state->input shares image's pixels & keeps them alive for the bands
+		bands = MapGen::normalMapTasks(heights, outputView, job.normalSettings, batchBandPixels);
+	}
+	else
+	{
+		const MapGen::ConstImageView inputView = MapGenerators::constImageView(state->input);
+		bands = job.edgeMap ? MapGen::edgeMapTasks(inputView, outputView, job.edgeSettings, batchBandPixels)
+			: MapGen::normalMapTasks(inputView, outputView, job.normalSettings, batchBandPixels);
+	}
+
+	state->bandCount = static_cast<int>(bands.size());
+	state->bandsLeft = state->bandCount;
+
+	for (const std::function<void()> & band : bands)
+	{
+		context.scheduler->add([&context, state, band]()
+		{
+			{
+				MapGen::StageTimer timer(&state->timings, state->job.edgeMap ? "edge_map" : "normal_map");
+				band();
+			}
+
+			if (--state->bandsLeft == 0)
+			{
+				finishBatchJob(context, *state);
+			}
+		});
+	}
+}
+
+// splits a manifest line into words, "quoted words" can have spaces in
+static QStringList splitManifestLine(const QString & line)
+{
+	QStringList words;
+	QString word;
+	bool quoted = false;
+	bool inWord = false;
+
+	for (const QChar c : line)
+	{
+		if (c == '"')
+		{
+			quoted = !quoted;
+			inWord = true;
+		}
+		else if (c.isSpace() && !quoted)
+		{
+			if (inWord)
+			{
+				words << word;
+				word.clear();
+				inWord = false;
+			}
+		}
+		else
+		{
+			word += c;
+			inWord = true;
+		}
+	}
+
+	if (inWord)
+	{
+		words << word;
+	}
+	return words;
+}
+
+// the options of one batch job, the input & output are filled in by the caller
+static bool readBatchJob(const QCommandLineParser & parser, BatchJob & job, QString & error)
+{
+	if (parser.isSet("stream") || parser.isSet("mips"))
+	{
+		error = "--stream & --mips can't be used in a batch";
+		return false;
+	}
+
+	const QString mapType = parser.value("type").toLower();
+	if (mapType != "normal" && mapType != "edge")
+	{
+		error = "unknown map type " + mapType + ", expected normal or edge";
+		return false;
+	}
+	job.edgeMap = mapType == "edge";
+
+	bool validCompression = false;
+	job.compressionLevel = parser.value("compression").toInt(&validCompression);
+	if (!validCompression || job.compressionLevel < 0 || job.compressionLevel > 9)
+	{
+		error = "invalid compression level " + parser.value("compression");
+		return false;
+	}
+
+	return job.edgeMap ? readEdgeSettings(parser, job.edgeSettings, error) : readNormalSettings(parser, job.normalSettings, error);
+}
+
+static bool checkBatchJob(const BatchJob & job, QString & error)
+{
+	MapGen::RawHeightFormat rawFormat;
+	if (MapGen::RawHeightMap::formatFromFileName(QFile::encodeName(job.input).toStdString(), rawFormat))
+	{
+		error = "raw height maps can't be used in a batch, " + job.input;
+		return false;
+	}
+
+	if (job.edgeMap && QFileInfo(job.output).suffix().toLower() == "dds")
+	{
+		error = "DDS output is BC5, which only holds normal maps, " + job.output;
+		return false;
+	}
+	return true;
+}
+
+// every job of a manifest or directory, scheduled across the pool together. see --batch
+static int runBatch(const QCommandLineParser & parser, const QList<QCommandLineOption> & options, MapGen::ThreadPool & threadPool)
+{
+	const QString batchPath = parser.value("batch");
+	const QFileInfo batchInfo(batchPath);
+	std::vector<BatchJob> jobs;
+	QString error;
+
+	if (batchInfo.isDir())
+	{
+		if (!parser.isSet("output"))
+		{
+			return fail("--output has to be the directory to write to when --batch is a directory");
+		}
+
+		// lossless formats only, a normal map saved with its input's .jpg would be ruined
+		const QString outputSuffix = parser.value("batch-format").toLower();
+		if (!QStringList({ "png", "qoi", "ppm", "dds" }).contains(outputSuffix))
+		{
+			return fail("--batch-format has to be png, qoi, ppm or dds, not " + parser.value("batch-format"));
+		}
+
+		const QDir outputDir(parser.value("output"));
+		if (!QDir().mkpath(outputDir.path()))
+		{
+			return fail("couldn't make " + outputDir.path());
+		}
+
+		// the maps would be written over the textures they're made from
+		if (QFileInfo(outputDir.path()).canonicalFilePath() == batchInfo.canonicalFilePath())
+		{
+			return fail("--output can't be the directory the --batch images are in");
+		}
+
+		// every image gets the command line's options
+		BatchJob directoryJob;
+		if (!readBatchJob(parser, directoryJob, error))
+		{
+			return fail(error);
+		}
+
+		// extensions are matched whatever their case, FOO.PNG is as much an image as foo.png
+		const QList<QByteArray> imageFormats = QImageReader::supportedImageFormats();
+		QStringList outputs;
+
+		for (const QFileInfo & file : QDir(batchPath).entryInfoList(QDir::Files, QDir::Name))
+		{
+			if (!imageFormats.contains(file.suffix().toLower().toLatin1()))
+			{
+				continue;
+			}
+
+			BatchJob job = directoryJob;
+			job.input = file.filePath();
+			job.output = outputDir.filePath(file.completeBaseName() + "." + outputSuffix);
+
+			// rock.png & rock.jpg would both be written to rock.png
+			if (outputs.contains(job.output, Qt::CaseInsensitive))
+			{
+				return fail("more than one image in " + batchPath + " would be saved as " + job.output);
+			}
+			outputs << job.output;
+			jobs.push_back(job);
+		}
+	}
+	else
+	{
+		QFile manifest(batchPath);
+		if (!manifest.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			return fail("couldn't open " + batchPath);
+		}
+
+		// paths in the manifest are from where it is
+		const QDir manifestDir = batchInfo.absoluteDir();
+		QTextStream lines(&manifest);
+
+		for (int lineNumber = 1; !lines.atEnd(); ++lineNumber)
+		{
+			const QString line = lines.readLine().trimmed();
+			if (line.isEmpty() || line.startsWith('#'))
+			{
+				continue;
+			}
+
+			// the command line's options come first so they're the defaults, the line's own override them
+			const QString where = batchPath + ":" + QString::number(lineNumber) + ": ";
+			QCommandLineParser jobParser;
+			jobParser.addOptions(options);
+			if (!jobParser.parse(QCoreApplication::arguments() + splitManifestLine(line)))
+			{
+				return fail(where + jobParser.errorText());
+			}
+
+			const QStringList files = jobParser.positionalArguments();
+			if (files.size() != 2)
+			{
+				return fail(where + "expected an input & an output file before the options");
+			}
+
+			BatchJob job;
+			if (!readBatchJob(jobParser, job, error))
+			{
+				return fail(where + error);
+			}
+			job.input = manifestDir.filePath(files[0]);
+			job.output = manifestDir.filePath(files[1]);
+			jobs.push_back(job);
+		}
+	}
+
+	for (BatchJob & job : jobs)
+	{
+		if (!checkBatchJob(job, error))
+		{
+			return fail(error);
+		}
+
+		const QSize size = QImageReader(job.input).size();
+		job.pixels = size.isValid() ? static_cast<long long>(size.width()) * size.height() : 0;
+	}
+
+	// each thread starts on the last job it was given, so adding the smallest first starts the biggest first &
+	// the jobs left to share out at the end are small ones
+	std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob & a, const BatchJob & b) { return a.pixels < b.pixels; });
+
+	const auto batchStart = std::chrono::steady_clock::now();
+
+	// each save is on the thread that finished the job's last band, so it deflates on that thread too
+	MapGen::ThreadPool savePool(1);
+	MapGen::TaskScheduler scheduler(threadPool);
+
+	ResultCache cache;
+	if (parser.isSet("cache") && !cache.open(parser.value("cache")))
+	{
+		return fail("couldn't make the cache directory " + parser.value("cache"));
+	}
+
+	// the JSON lines go to --stats if it's given, stdout otherwise
+	QFile reportFile;
+	if (!openStats(reportFile, parser.isSet("stats") ? parser.value("stats") : "-"))
+	{
+		return fail("couldn't write " + parser.value("stats"));
+	}
+	QTextStream report(&reportFile);
+
+	BatchContext context;
+	context.scheduler = &scheduler;
+	context.savePool = &savePool;
+	context.cache = parser.isSet("cache") ? &cache : nullptr;
+	context.report = &report;
+
+	for (const BatchJob & job : jobs)
+	{
+		scheduler.add([&context, job]() { startBatchJob(context, job); });
+	}
+	scheduler.run();
+
+	report << "{\"jobs\": " << static_cast<int>(jobs.size()) << ", \"failed\": " << context.failedJobs
+		<< ", \"threads\": " << threadPool.threadCount() << ", \"seconds\": " << QString::number(secondsSince(batchStart), 'f', 6) << "}" << endl;
+
+	return context.failedJobs == 0 ? 0 : 1;
+}
+
+int main(int argCount, char ** args)
+{
+	QCoreApplication app(argCount, args);
+	QCoreApplication::setApplicationName("ImageMapGenCli");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Generates normal maps & edge maps from diffuse maps & height maps.");
+	parser.addHelpOption();
+
+	QCommandLineOption inputOption(QStringList() << "i" << "input", "Input map to generate from.", "file");
+	QCommandLineOption outputOption(QStringList() << "o" << "output", "Where to write the generated map, normal maps saved as .dds are BC5 compressed.", "file");
+	QCommandLineOption typeOption(QStringList() << "t" << "type", "Output map type, normal or edge (default normal).", "type", "normal");
+	QCommandLineOption amplitudeOption(QStringList() << "a" << "amplitude", "Bump amplitude for normal maps (default 1.0).", "value", "1.0");
+	QCommandLineOption sensitivityOption(QStringList() << "s" << "sensitivity", "Edge map sensitivity, 0 - 765 (default 50).", "value", "50");
+	QCommandLineOption edgeDetectorOption("edge-detector", "How edges are found: difference (default, the quickest), sobel, "
+		"or canny for thin lines that follow the edges.", "detector", "difference");
+	QCommandLineOption primaryColourOption("primary-colour", "Edge map background colour (default #000000).", "colour", "#000000");
+	QCommandLineOption edgeColourOption("edge-colour", "Edge map edge colour (default #ffffff).", "colour", "#ffffff");
+	QCommandLineOption fastNormaliseOption("fast-normalise", "Normalise with an approximate reciprocal square root, quicker but not bit exact.");
+	QCommandLineOption borderOption("border", "What the heights past the edges of a normal map are: zero (default), clamp to the "
+		"edge heights or wrap around to the opposite edge for tiling textures.", "mode", "zero");
+	QCommandLineOption stencilOption("stencil", "How normal map slopes are worked out: central (default), or sobel, scharr or prewitt "
+		"which also take in the pixels either side & smooth out noisy height maps.", "stencil", "central");
+	QCommandLineOption streamOption("stream", "Generate a normal map a row at a time without loading the whole image, "
+		"for maps too big to fit in memory. The input must be a binary PGM, PPM or raw height map & the output is written as a PPM.");
+	QCommandLineOption compressionOption(QStringList() << "c" << "compression", "PNG compression level, 0 (stored, quickest) - 9 (smallest) "
+		"(default 6). For quick intermediate files save as .qoi or .ppm instead.", "level", "6");
+	QCommandLineOption mipsOption("mips", "Generate the full mip chain of a normal map, renormalised per level, written as "
+		"one file per level named <output>_mip<level>, or all in one file for .dds output.");
+	QCommandLineOption rawSizeOption("raw-size", "Size of a raw height map (.r16 .raw .r32), worked out from the file size if it's square.", "WIDTHxHEIGHT");
+	QCommandLineOption rawHeaderOption("raw-header", "Bytes to skip at the start of a raw height map (default 0).", "bytes", "0");
+	QCommandLineOption threadsOption(QStringList() << "j" << "threads", "Number of threads to generate with, 0 uses every core (default 0).", "count", "0");
+	QCommandLineOption cacheOption("cache", "Directory to keep generated maps in, keyed by a hash of the input's pixels & every setting "
+		"that changes the output. Inputs that haven't changed since they were last generated are copied from it instead. "
+		"Mips & raw or streamed height maps aren't cached.", "directory");
+	QCommandLineOption statsOption("stats", "Write how long each stage took (decode, convert, heights, gradients, normal map, "
+		"encode etc.) to file as JSON, - for stdout. With --batch each job's line goes there rather than stdout.", "file");
+	QCommandLineOption batchOption("batch", "Generate every job in a manifest, one job per line of the form <input> <output> [options], "
+		"or every image in a directory into the --output directory. Options on the command line are the defaults for every job. "
+		"The jobs are shared across the threads together with big maps split into bands, & each job's timing is printed as JSON.", "manifest");
+	QCommandLineOption batchFormatOption("batch-format", "File type the maps of a --batch directory are saved as, png (default), qoi, ppm or dds. "
+		"Each keeps its input's name with this extension.", "extension", "png");
+
+	const QList<QCommandLineOption> options = QList<QCommandLineOption>() << inputOption << outputOption << typeOption
+		<< amplitudeOption << sensitivityOption << edgeDetectorOption << primaryColourOption << edgeColourOption
+		<< fastNormaliseOption << borderOption << stencilOption << streamOption << compressionOption << mipsOption
+		<< rawSizeOption << rawHeaderOption << threadsOption << cacheOption << statsOption << batchOption << batchFormatOption;
+	parser.addOptions(options);
+
+	parser.process(app);
+
+	if (!parser.isSet(batchOption) && (!parser.isSet(inputOption) || !parser.isSet(outputOption)))
+	{
+		return fail("both --input and --output are required");
+	}
+
+	const QString mapType = parser.value(typeOption).toLower();
+	if (mapType != "normal" && mapType != "edge")
+	{
+		return fail("unknown map type " + mapType + ", expected normal or edge");
+	}
+
+	bool validThreads = false;
+	int threadCount = parser.value(threadsOption).toInt(&validThreads);
+	if (!validThreads || threadCount < 0)
+	{
+		return fail("invalid thread count " + parser.value(threadsOption));
+	}
+
+	// 1 thread runs everything on the main thread, anything else gets a pool
+	std::unique_ptr<MapGen::ThreadPool> threadPool;
+	if (threadCount != 1)
+	{
+		threadPool.reset(new MapGen::ThreadPool(threadCount));
+	}
+
+	// for the steps that always need a pool, one with a single thread keeps -j 1 on the main thread
+	MapGen::ThreadPool serialPool(1);
+	MapGen::ThreadPool & workPool = threadPool ? *threadPool : serialPool;
+
+	if (parser.isSet(batchOption))
+	{
+		return runBatch(parser, options, workPool);
+	}
+
+	bool validCompression = false;
+	const int compressionLevel = parser.value(compressionOption).toInt(&validCompression);
+	if (!validCompression || compressionLevel < 0 || compressionLevel > 9)
+	{
+		return fail("invalid compression level " + parser.value(compressionOption));
+	}
+
+	const QFileInfo outputInfo(parser.value(outputOption));
+	const bool ddsOutput = outputInfo.suffix().toLower() == "dds";
+	if (ddsOutput && mapType != "normal")
+	{
+		return fail("DDS output is BC5, which only holds normal maps");
+	}
+
+	MapGen::NormalMapSettings normalSettings;
+	QString settingsError;
+	if (!readNormalSettings(parser, normalSettings, settingsError))
+	{
+		return fail(settingsError);
+	}
+
+	MapGen::EdgeMapSettings edgeSettings;
+	if (mapType == "edge" && !readEdgeSettings(parser, edgeSettings, settingsError))
+	{
+		return fail(settingsError);
+	}
+
+	// every stage is timed for --stats, the generators add theirs through the control
+	const auto jobStart = std::chrono::steady_clock::now();
+	MapGen::StageTimings stageTimings;
+	MapGen::GenerationControl control;
+	control.setStageTimings(&stageTimings);
+	normalSettings.control = &control;
+	edgeSettings.control = &control;
+
+	const std::string inputPath = QFile::encodeName(parser.value(inputOption)).toStdString();
+	const std::string outputPath = QFile::encodeName(parser.value(outputOption)).toStdString();
+
+	// raw height files are mapped & read in place rather than loaded through QImage
+	MapGen::RawHeightMap rawHeights;
+	MapGen::RawHeightFormat rawFormat;
+	const bool rawInput = MapGen::RawHeightMap::formatFromFileName(inputPath, rawFormat);
+
+	if (rawInput)
+	{
+		int rawWidth = 0, rawHeight = 0;
+		if (parser.isSet(rawSizeOption))
+		{
+			const QStringList size = parser.value(rawSizeOption).toLower().split('x');
+			bool validWidth = false, validHeight = false;
+			if (size.size() == 2)
+			{
+				rawWidth = size[0].toInt(&validWidth);
+				rawHeight = size[1].toInt(&validHeight);
+			}
+			if (!validWidth || !validHeight || rawWidth <= 0 || rawHeight <= 0)
+			{
+				return fail("invalid raw size " + parser.value(rawSizeOption) + ", expected WIDTHxHEIGHT");
+			}
+		}
+
+		bool validHeader = false;
+		const int headerBytes = parser.value(rawHeaderOption).toInt(&validHeader);
+		if (!validHeader || headerBytes < 0)
+		{
+			return fail("invalid raw header size " + parser.value(rawHeaderOption));
+		}
+
+		if (mapType != "normal")
+		{
+			return fail("raw height maps only generate normal maps");
+		}
+
+		MapGen::StageTimer timer(&stageTimings, "map");
+		if (!rawHeights.open(inputPath, rawFormat, rawWidth, rawHeight, static_cast<size_t>(headerBytes)))
+		{
+			return fail("couldn't map " + parser.value(inputOption) + ", check it's square or pass --raw-size");
+		}
+	}
+
+	if (parser.isSet(streamOption))
+	{
+		if (mapType != "normal")
+		{
+			return fail("--stream only generates normal maps");
+		}
+		if (parser.isSet(mipsOption))
+		{
+			return fail("--stream & --mips can't be used together, the mip levels need the whole map");
+		}
+		if (normalSettings.border == MapGen::BorderMode::Wrap)
+		{
+			return fail("--stream can't wrap, the first row needs the last one");
+		}
+
+		MapGen::PnmHeightReader pnmReader;
+		std::unique_ptr<MapGen::RawHeightRowSource> rawReader;
+		MapGen::HeightRowSource * reader = &pnmReader;
+
+		if (rawInput)
+		{
+			rawReader.reset(new MapGen::RawHeightRowSource(rawHeights.view()));
+			reader = rawReader.get();
+		}
+		else if (!pnmReader.open(inputPath))
+		{
+			return fail("couldn't open " + parser.value(inputOption) + " as a binary PGM or PPM");
+		}
+
+		MapGen::PpmRowWriter writer;
+		if (!writer.open(outputPath, reader->width(), reader->height()))
+		{
+			return fail("couldn't write " + parser.value(outputOption));
+		}
+
+		const bool generated = MapGen::generateNormalMap(*reader, writer, normalSettings);
+		if (!writer.close() || !generated)
+		{
+			return fail("streaming " + parser.value(inputOption) + " to " + parser.value(outputOption) + " failed");
+		}
+		return finishJob(parser, stageTimings, jobStart, reader->width(), reader->height(), false);
+	}
+
+	QImage originalImage;
+	if (!rawInput)
+	{
+		{
+			MapGen::StageTimer timer(&stageTimings, "decode");
+			originalImage = QImage(parser.value(inputOption));
+		}
+		if (originalImage.isNull())
+		{
+			return fail("couldn't load " + parser.value(inputOption));
+		}
+
+		// converted here rather than in the generators so it's timed on its own, 16 bit heights are used as they are
+		MapGen::RawHeightView nativeHeights;
+		if (mapType == "edge" || !MapGenerators::heightView(originalImage, nativeHeights))
+		{
+			MapGen::StageTimer timer(&stageTimings, "convert");
+			originalImage = MapGenerators::toGeneratorFormat(originalImage);
+		}
+	}
+
+	if (parser.isSet(mipsOption))
+	{
+		if (mapType != "normal")
+		{
+			return fail("--mips only generates normal maps");
+		}
+
+		MapGen::HeightField heights;
+		if (rawInput)
+		{
+			heights.build(rawHeights.view(), &workPool, &control);
+		}
+		else
+		{
+			MapGenerators::buildHeightField(originalImage, heights, &workPool, &control);
+		}
+
+		const std::vector<QImage> levels = MapGenerators::generateNormalMapMips(heights, normalSettings, workPool);
+
+		{
+			MapGen::StageTimer timer(&stageTimings, "encode");
+
+			// a DDS holds the whole chain
+			if (ddsOutput)
+			{
+				if (!MapGenerators::saveDdsBC5(parser.value(outputOption), levels, workPool))
+				{
+					return fail("couldn't write " + parser.value(outputOption));
+				}
+			}
+			else
+			{
+				// anything else gets a file per level, name_mip0.png, name_mip1.png ...
+				for (size_t level = 0; level < levels.size(); ++level)
+				{
+					const QString levelPath = outputInfo.path() + "/" + outputInfo.completeBaseName() + "_mip" + QString::number(level) + "." + outputInfo.suffix();
+					if (!MapGenerators::saveImage(levelPath, levels[level], compressionLevel, workPool))
+					{
+						return fail("couldn't write " + levelPath);
+					}
+				}
+			}
+		}
+		return finishJob(parser, stageTimings, jobStart, heights.width(), heights.height(), false);
+	}
+
+	// an input that hasn't changed since it was last generated with the same settings is copied out of the cache
+	ResultCache cache;
+	QByteArray cacheKey;
+	const bool useCache = parser.isSet(cacheOption) && !rawInput;
+	if (useCache)
+	{
+		if (!cache.open(parser.value(cacheOption)))
+		{
+			return fail("couldn't make the cache directory " + parser.value(cacheOption));
+		}
+
+		{
+			MapGen::StageTimer timer(&stageTimings, "hash");
+			cacheKey = (mapType == "normal")
+				? ResultCache::normalMapKey(originalImage, normalSettings, parser.value(outputOption), compressionLevel, workPool)
+				: ResultCache::edgeMapKey(originalImage, edgeSettings, parser.value(outputOption), compressionLevel, workPool);
+		}
+
+		const auto copyStart = std::chrono::steady_clock::now();
+		if (cache.fetch(cacheKey, parser.value(outputOption)))
+		{
+			stageTimings.add("copy", secondsSince(copyStart));
+			return finishJob(parser, stageTimings, jobStart, originalImage.width(), originalImage.height(), true);
+		}
+	}
+
+	QImage generatedMap;
+
+	if (rawInput)
+	{
+		generatedMap = MapGenerators::generateNormalMap(rawHeights.view(), normalSettings, threadPool.get());
+	}
+	else
+	{
+		if (mapType == "normal")
+		{
+			generatedMap = MapGenerators::generateNormalMap(originalImage, normalSettings, threadPool.get());
+		}
+		else
+		{
+			generatedMap = MapGenerators::generateEdgeMap(originalImage, edgeSettings, threadPool.get());
+		}
+	}
+
+	bool saved;
+	{
+		MapGen::StageTimer timer(&stageTimings, "encode");
+		saved = MapGenerators::saveImage(parser.value(outputOption), generatedMap, compressionLevel, workPool);
+	}
+	if (!saved)
+	{
+		return fail("couldn't write " + parser.value(outputOption));
+	}
+
+	if (useCache)
+	{
+		MapGen::StageTimer timer(&stageTimings, "cache_store");
+		if (!cache.store(cacheKey, parser.value(outputOption)))
+		{
+			QTextStream(stderr) << "ImageMapGenCli: couldn't add " << parser.value(outputOption) << " to the cache" << endl;
+		}
+	}
+
+	return finishJob(parser, stageTimings, jobStart, generatedMap.width(), generatedMap.height(), false);
+}
@@ -0,0 +1,142 @@
+#include "resultcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	// change whenever a generator's output or the keys do, so entries made by older builds stop matching
+	const char * const cacheVersion = "ImageMapGen result cache 2";
+
+	// the pixels are hashed in bands of about this many bytes. fixed rather than per thread so a map gets the same key
+	// however many threads hashed it
+	const int hashBandBytes = 4 << 20;
+
+	// hash of every band's hash, rows are hashed without the padding on the end of them
+	QByteArray pixelHash(const QImage & image, MapGen::ThreadPool & threadPool)
+	{
+		const int rowBytes = (image.width() * image.depth() + 7) / 8;
+		const int bandRows = std::max(1, hashBandBytes / std::max(1, rowBytes));
+		const int bandCount = (image.height() + bandRows - 1) / bandRows;
+
+		std::vector<QByteArray> bandHashes(bandCount);
+		threadPool.parallelFor(bandCount, 1, [&](int firstBand, int lastBand)
+		{
+			for (int band = firstBand; band < lastBand; ++band)
+			{
+				QCryptographicHash hash(QCryptographicHash::Sha1);
+				const int lastRow = std::min(image.height(), (band + 1) * bandRows);
+				for (int y = band * bandRows; y < lastRow; ++y)
+				{
+					hash.addData(reinterpret_cast<const char *>(image.constScanLine(y)), rowBytes);
+				}
+				bandHashes[band] = hash.result();
+			}
+		});
+
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		for (const QByteArray & bandHash : bandHashes)
+		{
+			hash.addData(bandHash);
+		}
+		return hash.result();
+	}
+
+	QByteArray makeKey(const QImage & input, const QString & settings, const QString & outputFileName, int compressionLevel, MapGen::ThreadPool & threadPool)
+	{
+		const QString description = QString(cacheVersion) + "\n" + settings + "\n"
+			+ QString::number(input.width()) + "x" + QString::number(input.height()) + " format " + QString::number(static_cast<int>(input.format())) + "\n"
+			+ QFileInfo(outputFileName).suffix().toLower() + " level " + QString::number(compressionLevel) + "\n";
+
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		hash.addData(description.toUtf8());
+		hash.addData(pixelHash(input, threadPool));
+
+		// the pixels of a palette image are only indices, the colours they stand for are in the table
+		const QVector<QRgb> colourTable = input.colorTable();
+		hash.addData(reinterpret_cast<const char *>(colourTable.constData()), colourTable.size() * static_cast<int>(sizeof(QRgb)));
+		return hash.result().toHex();
+	}
+}
+
+bool ResultCache::open(const QString & directory)
+{
+	m_directory = directory;
+	return QDir().mkpath(directory);
+}
+
+QByteArray ResultCache::normalMapKey(const QImage & input, const MapGen::NormalMapSettings & settings, const QString & outputFileName,
+	int compressionLevel, MapGen::ThreadPool & threadPool)
+{
+	// 9 digits gets the amplitude back exactly
+	const QString description = "normal amplitude " + QString::number(settings.amplitude, 'g', 9)
+		+ " fast normalise " + QString::number(settings.fastNormalise ? 1 : 0)
+		+ " border " + QString::number(static_cast<int>(settings.border))
+		+ " stencil " + QString::number(static_cast<int>(settings.stencil));
+	return makeKey(input, description, outputFileName, compressionLevel, threadPool);
+}
+
+QByteArray ResultCache::edgeMapKey(const QImage & input, const MapGen::EdgeMapSettings & settings, const QString & outputFileName,
+	int compressionLevel, MapGen::ThreadPool & threadPool)
+{
+	const QString description = "edge detector " + QString::number(static_cast<int>(settings.detector))
+		+ " sensitivity " + QString::number(settings.sensitivity)
+		+ " primary " + QString::number(settings.primaryColour, 16)
+		+ " edge " + QString::number(settings.edgeColour, 16);
+	return makeKey(input, description, outputFileName, compressionLevel, threadPool);
+}
+
+bool ResultCache::fetch(const QByteArray & key, const QString & outputFileName) const
+{
+	const QString entry = entryPath(key, outputFileName);
+	if (!QFile::exists(entry))
+	{
+		return false;
+	}
+
+	// copy won't overwrite
+	QFile::remove(outputFileName);
+	return QFile::copy(entry, outputFileName);
+}
+
+bool ResultCache::store(const QByteArray & key, const QString & outputFileName) const
+{
+	const QString entry = entryPath(key, outputFileName);
+
+	QFile finished(outputFileName);
+	QTemporaryFile part(m_directory + "/XXXXXX.part");
+	if (!finished.open(QIODevice::ReadOnly) || !part.open())
+	{
+		return false;
+	}
+
+	// a chunk at a time, a 16K map can be hundreds of MB
+	QByteArray chunk;
+	while (!(chunk = finished.read(1 << 20)).isEmpty())
+	{
+		if (part.write(chunk) != chunk.size())
+		{
+			return false;
+		}
+	}
+	if (!finished.atEnd())
+	{
+		return false;
+	}
+
+	// renamed into place so nothing ever sees half an entry. if another job stored the same one first the part's removed
+	return part.rename(entry) || QFile::exists(entry);
+}
+
+QString ResultCache::entryPath(const QByteArray & key, const QString & outputFileName) const
+{
+	const QString suffix = QFileInfo(outputFileName).suffix().toLower();
+	return m_directory + "/" + QString::fromLatin1(key) + (suffix.isEmpty() ? QString() : "." + suffix);
+}
@@ -0,0 +1,38 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+#include <Generators.h>
+
+// generated maps kept on disk under a hash of everything that goes into them, the input's pixels, the map type & its
+// settings, & the output format & compression level since the same map saves to different files. a build that's seen
+// a texture before copies the stored file instead of generating & saving it again. entries are never removed, the
+// directory can be cleared whenever
+class ResultCache
+{
+public:
+	// makes the directory if it isn't there, false if it can't
+	bool open(const QString & directory);
+
+	// keys for generating input into outputFileName, the pixels are hashed in bands across the pool
+	static QByteArray normalMapKey(const QImage & input, const MapGen::NormalMapSettings & settings, const QString & outputFileName,
+		int compressionLevel, MapGen::ThreadPool & threadPool);
+	static QByteArray edgeMapKey(const QImage & input, const MapGen::EdgeMapSettings & settings, const QString & outputFileName,
+		int compressionLevel, MapGen::ThreadPool & threadPool);
+
+	// copies the entry for key to outputFileName, replacing it. false if there isn't one
+	bool fetch(const QByteArray & key, const QString & outputFileName) const;
+
+	// adds the finished outputFileName as the entry for key, thread safe & safe with other processes sharing the directory
+	bool store(const QByteArray & key, const QString & outputFileName) const;
+
+private:
+	QString entryPath(const QByteArray & key, const QString & outputFileName) const;
+
+	QString m_directory;
+};
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,33 @@
+#include "mapgenerationtask.h"
+#include "mapgenerators.h"
+
+#include <QElapsedTimer>
+
+MapGenerationTask::MapGenerationTask(Work work, long long totalRows, QObject *parent)
+	: QObject(parent)
+	, m_work(work)
+{
+	m_control.setTotalRows(totalRows);
+	m_control.setStageTimings(&m_stageTimings);
+
+	// called on the pool threads, the signal gets queued over to the receiver's thread
+	m_control.setProgressCallback([this](int percent) { emit progressChanged(percent); });
+}
+
+void MapGenerationTask::cancel()
+{
+	m_control.cancel();
+}
+
+void MapGenerationTask::run()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QImage generatedMap = m_work(m_control);
+
+	const QString stageSummary = tr("Generated in %1 ms (%2)").arg(timer.nsecsElapsed() / 1.0e6, 0, 'f', 1).arg(MapGenerators::stageSummary(m_stageTimings));
+
+	const bool cancelled = m_control.isCancelled();
+	emit finished(cancelled ? QImage() : generatedMap, cancelled, stageSummary);
+}
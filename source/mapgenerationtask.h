@@ -0,0 +1,42 @@
+#ifndef MAPGENERATIONTASK_H
+#define MAPGENERATIONTASK_H
+
+#include <QObject>
+#include <QImage>
+
+#include <GenerationControl.h>
+#include <StageTimings.h>
+
+#include <functional>
+
+// runs a map generation on a worker thread, reporting progress & handing the result back through queued signals
+class MapGenerationTask : public QObject
+{
+	Q_OBJECT
+
+public:
+	// work should pass the control on to the generators so it can be followed & cancelled
+	typedef std::function<QImage(MapGen::GenerationControl & control)> Work;
+
+	explicit MapGenerationTask(Work work, long long totalRows, QObject *parent = 0);
+
+	// safe to call from any thread, the generators stop at the next row
+	void cancel();
+
+	void run();
+
+signals:
+	void progressChanged(int percent);
+
+	// stageSummary is how long the work took & each stage of it, for the status bar
+	void finished(QImage generatedMap, bool cancelled, QString stageSummary);
+
+private:
+	Work m_work;
+	MapGen::GenerationControl m_control;
+
+	// the generators add their stages through m_control
+	MapGen::StageTimings m_stageTimings;
+};
+
+#endif // MAPGENERATIONTASK_H
@@ -0,0 +1,340 @@
+#include "mapgenerators.h"
+
+#include <BlockCompression.h>
+#include <BufferPool.h>
+#include <DdsFile.h>
+#include <PngFile.h>
+#include <PnmStream.h>
+#include <QoiFile.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QVector>
+
+namespace
+{
+	void releasePooledImage(void * buffer)
+	{
+		delete static_cast<MapGen::PooledBuffer *>(buffer);
+	}
+
+	// the formats height maps usually load as, converted a row at a time into a pooled image. false for any other format
+	bool convertToPooled(const QImage & image, QImage & converted)
+	{
+		QVector<QRgb> colours;
+		switch (image.format())
+		{
+		case QImage::Format_Indexed8:
+			// anything past the end of the colour table comes out black
+			colours = image.colorTable();
+			colours.resize(256);
+			for (int i = image.colorTable().size(); i < 256; ++i)
+			{
+				colours[i] = qRgb(0, 0, 0);
+			}
+			break;
+		case QImage::Format_Grayscale8:
+		case QImage::Format_RGB888:
+			break;
+		default:
+			return false;
+		}
+
+		converted = MapGenerators::pooledImage(image.width(), image.height(), QImage::Format_ARGB32);
+		for (int y = 0; y < image.height(); ++y)
+		{
+			const uchar * in = image.constScanLine(y);
+			QRgb * out = reinterpret_cast<QRgb *>(converted.scanLine(y));
+
+			switch (image.format())
+			{
+			case QImage::Format_Indexed8:
+				for (int x = 0; x < image.width(); ++x)
+				{
+					out[x] = colours[in[x]];
+				}
+				break;
+			case QImage::Format_Grayscale8:
+				for (int x = 0; x < image.width(); ++x)
+				{
+					out[x] = qRgb(in[x], in[x], in[x]);
+				}
+				break;
+			default:
+				for (int x = 0; x < image.width(); ++x)
+				{
+					out[x] = qRgb(in[x * 3], in[x * 3 + 1], in[x * 3 + 2]);
+				}
+				break;
+			}
+		}
+		return true;
+	}
+}
+
+QImage MapGenerators::toGeneratorFormat(const QImage & image)
+{
+	if (image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32)
+	{
+		return image;
+	}
+
+	QImage converted;
+	if (convertToPooled(image, converted))
+	{
+		return converted;
+	}
+	return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+QImage MapGenerators::pooledImage(int width, int height, QImage::Format format)
+{
+	const int bytesPerLine = width * 4;
+	MapGen::PooledBuffer * buffer = new MapGen::PooledBuffer(MapGen::BufferPool::defaultPool().acquire(static_cast<size_t>(bytesPerLine) * height));
+	if (buffer->isEmpty())
+	{
+		delete buffer;
+		return QImage(width, height, format);
+	}
+	return QImage(buffer->data(), width, height, bytesPerLine, format, releasePooledImage, buffer);
+}
+
+MapGen::ConstImageView MapGenerators::constImageView(const QImage & image)
+{
+	return MapGen::ConstImageView(image.constBits(), image.width(), image.height(), image.bytesPerLine());
+}
+
+MapGen::ImageView MapGenerators::imageView(QImage & image)
+{
+	return MapGen::ImageView(image.bits(), image.width(), image.height(), image.bytesPerLine());
+}
+
+bool MapGenerators::heightView(const QImage & image, MapGen::RawHeightView & view)
+{
+	MapGen::RawHeightFormat format;
+	switch (image.format())
+	{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+	case QImage::Format_Grayscale16:
+		format = MapGen::RawHeightFormat::R16;
+		break;
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+	case QImage::Format_RGBA64:
+	case QImage::Format_RGBX64:
+		format = MapGen::RawHeightFormat::RGBA16;
+		break;
+#endif
+	default:
+		return false;
+	}
+
+	view = MapGen::RawHeightView(image.constBits(), image.width(), image.height(), image.bytesPerLine(), format);
+	return true;
+}
+
+QImage MapGenerators::generateEdgeMap(const QImage & originalImage, const MapGen::EdgeMapSettings & settings, MapGen::ThreadPool * threadPool)
+{
+	const QImage input = toGeneratorFormat(originalImage);
+	QImage generatedMap = pooledImage(input.width(), input.height());
+
+	if (threadPool)
+	{
+		MapGen::generateEdgeMap(constImageView(input), imageView(generatedMap), settings, *threadPool);
+	}
+	else
+	{
+		MapGen::generateEdgeMap(constImageView(input), imageView(generatedMap), settings);
+	}
+
+	return generatedMap;
+}
+
+QImage MapGenerators::generateNormalMap(const QImage & originalImage, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool)
+{
+	MapGen::RawHeightView heights;
+	if (heightView(originalImage, heights))
+	{
+		return generateNormalMap(heights, settings, threadPool);
+	}
+
+	const QImage input = toGeneratorFormat(originalImage);
+	QImage generatedMap = pooledImage(input.width(), input.height());
+
+	if (threadPool)
+	{
+		MapGen::generateNormalMap(constImageView(input), imageView(generatedMap), settings, *threadPool);
+	}
+	else
+	{
+		MapGen::generateNormalMap(constImageView(input), imageView(generatedMap), settings);
+	}
+
+	return generatedMap;
+}
+
+void MapGenerators::buildHeightField(const QImage & originalImage, MapGen::HeightField & heights, MapGen::ThreadPool * threadPool, MapGen::GenerationControl * control)
+{
+	MapGen::RawHeightView nativeHeights;
+	if (heightView(originalImage, nativeHeights))
+	{
+		heights.build(nativeHeights, threadPool, control);
+		return;
+	}
+
+	const QImage input = toGeneratorFormat(originalImage);
+	heights.build(constImageView(input), threadPool, control);
+}
+
+QImage MapGenerators::generateNormalMap(const MapGen::HeightField & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool)
+{
+	QImage generatedMap = pooledImage(heights.width(), heights.height());
+
+	if (threadPool)
+	{
+		MapGen::generateNormalMap(heights, imageView(generatedMap), settings, *threadPool);
+	}
+	else
+	{
+		MapGen::generateNormalMap(heights, imageView(generatedMap), settings);
+	}
+
+	return generatedMap;
+}
+
+QImage MapGenerators::generateNormalMap(const MapGen::GradientField & gradients, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool)
+{
+	QImage generatedMap = pooledImage(gradients.width(), gradients.height());
+
+	if (threadPool)
+	{
+		MapGen::generateNormalMap(gradients, imageView(generatedMap), settings, *threadPool);
+	}
+	else
+	{
+		MapGen::generateNormalMap(gradients, imageView(generatedMap), settings);
+	}
+
+	return generatedMap;
+}
+
+QImage MapGenerators::generateNormalMap(const MapGen::RawHeightView & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool)
+{
+	QImage generatedMap = pooledImage(heights.width, heights.height);
+
+	if (threadPool)
+	{
+		MapGen::generateNormalMap(heights, imageView(generatedMap), settings, *threadPool);
+	}
+	else
+	{
+		MapGen::generateNormalMap(heights, imageView(generatedMap), settings);
+	}
+
+	return generatedMap;
+}
+
+std::vector<QImage> MapGenerators::generateNormalMapMips(const MapGen::HeightField & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool & threadPool)
+{
+	const int levelCount = MapGen::mipLevelCount(heights.width(), heights.height());
+
+	std::vector<QImage> levels(levelCount);
+	std::vector<MapGen::ImageView> levelViews(levelCount);
+
+	for (int level = 0; level < levelCount; ++level)
+	{
+		levels[level] = pooledImage(MapGen::mipLevelSize(heights.width(), level), MapGen::mipLevelSize(heights.height(), level));
+		levelViews[level] = imageView(levels[level]);
+	}
+
+	MapGen::generateNormalMapMips(heights, levelViews, settings, threadPool);
+	return levels;
+}
+
+bool MapGenerators::saveImage(const QString & fileName, const QImage & image, int compressionLevel, MapGen::ThreadPool & threadPool)
+{
+	const QString suffix = QFileInfo(fileName).suffix().toLower();
+	const std::string path = QFile::encodeName(fileName).toStdString();
+
+	if (suffix == "dds")
+	{
+		return saveDdsBC5(fileName, { image }, threadPool);
+	}
+
+	const QImage pixels = toGeneratorFormat(image);
+	const bool alpha = pixels.hasAlphaChannel();
+
+	if (suffix == "qoi")
+	{
+		return MapGen::writeQoi(path, constImageView(pixels), alpha);
+	}
+
+	if (suffix == "ppm")
+	{
+		MapGen::PpmRowWriter writer;
+		bool written = writer.open(path, pixels.width(), pixels.height());
+		for (int y = 0; y < pixels.height() && written; ++y)
+		{
+			written = writer.writeRow(reinterpret_cast<const MapGen::Pixel *>(pixels.constScanLine(y)));
+		}
+		return writer.close() && written;
+	}
+
+	if (suffix == "png" && MapGen::pngWriterAvailable())
+	{
+		return MapGen::writePng(path, constImageView(pixels), alpha, compressionLevel, threadPool);
+	}
+
+	// Qt's png quality runs the opposite way to the compression level, 100 is level 0 & 9 is level 9
+	const int quality = suffix == "png" ? 100 - (compressionLevel * 91 + 8) / 9 : -1;
+	return image.save(fileName, nullptr, quality);
+}
+
+bool MapGenerators::saveDdsBC5(const QString & fileName, const std::vector<QImage> & levels, MapGen::ThreadPool & threadPool)
+{
+	if (levels.empty())
+	{
+		return false;
+	}
+
+	// compressed straight from the generated pixels
+	std::vector<std::vector<unsigned char>> compressedLevels(levels.size());
+	for (size_t level = 0; level < levels.size(); ++level)
+	{
+		const QImage input = toGeneratorFormat(levels[level]);
+		compressedLevels[level].resize(MapGen::bc5Size(input.width(), input.height()));
+		MapGen::compressBC5(constImageView(input), compressedLevels[level].data(), threadPool);
+	}
+
+	return MapGen::writeDdsBC5(QFile::encodeName(fileName).toStdString(), levels[0].width(), levels[0].height(), compressedLevels);
+}
+
+QImage MapGenerators::heightFieldPreview(const MapGen::HeightField & heights)
+{
+	QImage preview(heights.width(), heights.height(), QImage::Format_RGB32);
+
+	for (int y = 0; y < heights.height(); ++y)
+	{
+		const float * heightRow = heights.row(y);
+		QRgb * previewRow = reinterpret_cast<QRgb *>(preview.scanLine(y));
+
+		for (int x = 0; x < heights.width(); ++x)
+		{
+			const int grey = static_cast<int>(qBound(0.0f, heightRow[x], 1.0f) * 255.0f);
+			previewRow[x] = qRgb(grey, grey, grey);
+		}
+	}
+
+	return preview;
+}
+
+QString MapGenerators::stageSummary(const MapGen::StageTimings & timings)
+{
+	QStringList stages;
+	for (const MapGen::StageTimings::Stage & stage : timings.stages())
+	{
+		stages << QString::fromStdString(stage.name) + " " + QString::number(stage.seconds * 1000.0, 'f', 1) + " ms";
+	}
+	return stages.join(", ");
+}
@@ -0,0 +1,61 @@
+#ifndef MAPGENERATORS_H
+#define MAPGENERATORS_H
+
+#include <QImage>
+#include <QString>
+
+#include <Generators.h>
+
+#include <vector>
+
+// QImage glue for the MapGenCore generators, these only need QtGui so they're
+// shared by the window (ImageMapGenExe) & the command line tool (ImageMapGenCli)
+namespace MapGenerators
+{
+	// returns the image in a format MapGenCore can read (32 bit 0xAARRGGBB), without copying if it already is.
+	// 8 bit grey, palette & 24 bit images are converted into a pooledImage()
+	QImage toGeneratorFormat(const QImage & image);
+
+	// an uninitialised 32 bit image over a block from MapGen::BufferPool::defaultPool(), the block goes back to the pool
+	// when the last copy of the image is destroyed so the next map the same size reuses it
+	QImage pooledImage(int width, int height, QImage::Format format = QImage::Format_RGB32);
+
+	// views over the pixels of a Format_RGB32 / Format_ARGB32 image
+	MapGen::ConstImageView constImageView(const QImage & image);
+	MapGen::ImageView imageView(QImage & image);
+
+	// views the heights of a 16 bit image (Format_Grayscale16, Format_RGBA64, Format_RGBX64) in place, so they're used
+	// at full precision without converting down to 32 bit pixels. returns false for every other format
+	bool heightView(const QImage & image, MapGen::RawHeightView & view);
+
+	// threadPool can be null to generate on the calling thread, cancelling through settings.control gives back an unfinished map.
+	// normal maps & height fields are made from the native pixels of 16 bit images, everything else is converted to 32 bit first
+	QImage generateEdgeMap(const QImage & originalImage, const MapGen::EdgeMapSettings & settings, MapGen::ThreadPool * threadPool);
+	QImage generateNormalMap(const QImage & originalImage, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool);
+
+	// for regenerating the same input with different settings, build the heights once & generate from them
+	void buildHeightField(const QImage & originalImage, MapGen::HeightField & heights, MapGen::ThreadPool * threadPool, MapGen::GenerationControl * control = nullptr);
+	QImage generateNormalMap(const MapGen::HeightField & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool);
+	QImage generateNormalMap(const MapGen::GradientField & gradients, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool);
+
+	// normal map straight from raw height samples, a mapped raw file or a 16 bit image's heightView()
+	QImage generateNormalMap(const MapGen::RawHeightView & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool * threadPool);
+
+	// every level of the normal map's mip chain, [0] full size. see MapGen::generateNormalMapMips
+	std::vector<QImage> generateNormalMapMips(const MapGen::HeightField & heights, const MapGen::NormalMapSettings & settings, MapGen::ThreadPool & threadPool);
+
+	// saves by the file's extension. .png is deflated across the thread pool at compressionLevel (0 stored - 9 smallest),
+	// .qoi & .ppm are quick uncompressed-ish formats for intermediate files, .dds is BC5 & anything else goes through Qt
+	bool saveImage(const QString & fileName, const QImage & image, int compressionLevel, MapGen::ThreadPool & threadPool);
+
+	// compresses normal maps to BC5 & writes them as one DDS, levels[0] full size & any after it its mip chain
+	bool saveDdsBC5(const QString & fileName, const std::vector<QImage> & levels, MapGen::ThreadPool & threadPool);
+
+	// greyscale picture of the heights for showing in the window, heights outside 0 - 1 are clamped
+	QImage heightFieldPreview(const MapGen::HeightField & heights);
+
+	// the stages one line at a time for the status bar, "decode 12.3 ms, convert 1.2 ms"
+	QString stageSummary(const MapGen::StageTimings & timings);
+}
+
+#endif // MAPGENERATORS_H
@@ -1,19 +1,38 @@
 #include "mapgeneratorwindow.h"
 #include "ui_mapgeneratorwindow.h"
+#include "mapgenerators.h"
 
+#include <BufferPool.h>
+
+#include <QFile>
 #include <QFileDialog>
+#include <QGuiApplication>
+#include <QLabel>
+#include <QMessageBox>
+#include <QScreen>
 #include <QValidator>
 #include <QColorDialog>
+#include <QElapsedTimer>
+#include <QThread>
 
 MapGeneratorWindow::MapGeneratorWindow(QWidget *parent) 
 	: QMainWindow(parent)
 	, ui(new Ui::MapGeneratorWindow)
+	, m_generationThread(nullptr)
+	, m_generationTask(nullptr)
 {
     ui->setupUi(this);
 }
 
 MapGeneratorWindow::~MapGeneratorWindow()
 {
+	// don't leave a worker writing into the caches as they're destroyed
+	if (isGenerating())
+	{
+		m_generationTask->cancel();
+		endGeneration();
+	}
+
     delete ui;
 }
 
@@ -36,17 +55,43 @@ void MapGeneratorWindow::init()
 	ui->comboBox_outputMapType->addItems(outputMapTypes);
 	ui->comboBox_outputMapType->setCurrentIndex(1);
 
+	// what's past the edges of the height map, wrap for tiling textures
+	ui->comboBox_borderMode->addItem("Zero", static_cast<int>(MapGen::BorderMode::Zero));
+	ui->comboBox_borderMode->addItem("Clamp", static_cast<int>(MapGen::BorderMode::Clamp));
+	ui->comboBox_borderMode->addItem("Wrap", static_cast<int>(MapGen::BorderMode::Wrap));
+	ui->comboBox_borderMode->setCurrentIndex(0);
+
+	// the 3x3 stencils smooth out noisy scans without blurring them first
+	ui->comboBox_stencil->addItem("Central Difference", static_cast<int>(MapGen::GradientStencil::CentralDifference));
+	ui->comboBox_stencil->addItem("Sobel", static_cast<int>(MapGen::GradientStencil::Sobel));
+	ui->comboBox_stencil->addItem("Scharr", static_cast<int>(MapGen::GradientStencil::Scharr));
+	ui->comboBox_stencil->addItem("Prewitt", static_cast<int>(MapGen::GradientStencil::Prewitt));
+	ui->comboBox_stencil->setCurrentIndex(0);
+
+	// Sobel & Canny are cleaner on photos, the plain difference is the quickest
+	ui->comboBox_edgeDetector->addItem("Difference", static_cast<int>(MapGen::EdgeDetector::Difference));
+	ui->comboBox_edgeDetector->addItem("Sobel", static_cast<int>(MapGen::EdgeDetector::Sobel));
+	ui->comboBox_edgeDetector->addItem("Canny", static_cast<int>(MapGen::EdgeDetector::Canny));
+	ui->comboBox_edgeDetector->setCurrentIndex(0);
+
 	// connect ui object to correct methods
 	connect(ui->actionSet_Input_Map, &QAction::triggered, this, &MapGeneratorWindow::onOpenMap);
 	connect(ui->pushButton_generateMap, &QPushButton::pressed, this, &MapGeneratorWindow::onGenerateMapButtonPressed);
 	connect(ui->actionSave_Output_Map, &QAction::triggered, this, &MapGeneratorWindow::onSaveOutputMap);
 	connect(ui->pushButton_edgeMapPrimaryColour, &QPushButton::pressed, this, &MapGeneratorWindow::onEdgeMapPrimaryColour);
 	connect(ui->pushButton_edgeMapEdgeColour, &QPushButton::pressed, this, &MapGeneratorWindow::onEdgeMapEdgeColour);
+	connect(ui->lineEdit_bumpAmp, &QLineEdit::editingFinished, this, &MapGeneratorWindow::onBumpAmpEdited);
+	connect(ui->pushButton_cancelGeneration, &QPushButton::pressed, this, &MapGeneratorWindow::onCancelGeneration);
 
 
 	// disable the generate button (gets re enabled once an input map is provided)
 	ui->pushButton_generateMap->setDisabled(true);
 
+	// only shown while a map is generating
+	ui->progressBar_generation->setRange(0, 100);
+	ui->progressBar_generation->setVisible(false);
+	ui->pushButton_cancelGeneration->setVisible(false);
+
 	// add QValidator objects for the
 	ui->lineEdit_bumpAmp->setValidator(new QDoubleValidator());
 	ui->lineEdit_edgeMapSensivity->setValidator(new QIntValidator(0, 255 * 3));
@@ -69,8 +114,9 @@ void MapGeneratorWindow::init()
 
 void MapGeneratorWindow::onOpenMap()
 {
-	// just deal with image files
-	QString inputFileName = QFileDialog::getOpenFileName(this, tr("Select an Image file"), QString(""), tr("Image files (*.bmp;*.jpg;*.png)"));
+	// image files, or raw height maps straight from terrain tools
+	QString inputFileName = QFileDialog::getOpenFileName(this, tr("Select an Image file"), QString(""),
+		tr("Image files (*.bmp;*.jpg;*.png);;Raw height maps (*.r16 *.raw *.r32)"));
 
 	if (inputFileName == QString())
 	{
@@ -78,9 +124,58 @@ void MapGeneratorWindow::onOpenMap()
 		return;
 	}
 
-	QPixmap imagePixelMap(inputFileName);
+	// timed so the status bar can say where opening went
+	QElapsedTimer openTimer;
+	openTimer.start();
+	MapGen::StageTimings timings;
+
+	// if the new map can't be opened the old one stays, along with its cached heights & gradients
+	MapGen::RawHeightFormat rawFormat;
+	if (MapGen::RawHeightMap::formatFromFileName(QFile::encodeName(inputFileName).toStdString(), rawFormat))
+	{
+		if (!openRawHeightMap(inputFileName, rawFormat, timings))
+		{
+			return;
+		}
+	}
+	else
+	{
+		QImage image;
+		{
+			MapGen::StageTimer timer(&timings, "decode");
+			image = QImage(inputFileName);
+		}
+		if (image.isNull())
+		{
+			QMessageBox::warning(this, tr("Open map"), tr("Couldn't read %1 as an image.").arg(inputFileName));
+			return;
+		}
+
+		// the cached heights & gradients belong to the old map, & a new map is rarely the same size so the
+		// blocks they were in aren't worth keeping
+		m_inputHeights.clear();
+		m_inputGradients.clear();
+		MapGen::BufferPool::defaultPool().trim();
+
+		// 16 bit height maps are kept as they were loaded so they're generated from at full precision,
+		// anything else is converted to the generators' format once here rather than every generation
+		m_inputImage = image;
+		MapGen::RawHeightView nativeHeights;
+		if (MapGenerators::heightView(m_inputImage, nativeHeights))
+		{
+			ui->comboBox_inputMapType->setCurrentText("Height Map");
+		}
+		else
+		{
+			MapGen::StageTimer timer(&timings, "convert");
+			m_inputImage = MapGenerators::toGeneratorFormat(m_inputImage);
+		}
+
+		MapGen::StageTimer timer(&timings, "preview");
+		showPreview(ui->label_inputMap, m_inputImage);
+	}
 
-	ui->label_inputMap->setPixmap(imagePixelMap);
+	ui->statusBar->showMessage(tr("Opened in %1 ms (%2)").arg(openTimer.nsecsElapsed() / 1.0e6, 0, 'f', 1).arg(MapGenerators::stageSummary(timings)));
 
 	// enable the generate button
 	ui->pushButton_generateMap->setDisabled(false);
@@ -90,15 +185,23 @@ void MapGeneratorWindow::onSaveOutputMap()
 {
 	// make sure that theres a map to save, if not return
 
-	const QPixmap * outputImage = ui->label_outputMap->pixmap();
-
-	if (outputImage)
+	if (!m_outputImage.isNull())
 	{
-		QString saveFileStr = QFileDialog::getSaveFileName(this, tr("Save output"), "", tr("Images (*.png)"));
+		QString saveFileStr = QFileDialog::getSaveFileName(this, tr("Save output"), "",
+			tr("Images (*.png);;BC5 compressed normal map (*.dds);;Quick uncompressed image (*.qoi)"));
 		if (saveFileStr != QString())
 		{
-			// save the file
-			outputImage->save(saveFileStr, "png");
+			// save the full size map, the label only has a preview
+			QElapsedTimer encodeTimer;
+			encodeTimer.start();
+			if (MapGenerators::saveImage(saveFileStr, m_outputImage, 6, MapGen::ThreadPool::defaultPool()))
+			{
+				ui->statusBar->showMessage(tr("Saved in %1 ms").arg(encodeTimer.nsecsElapsed() / 1.0e6, 0, 'f', 1));
+			}
+			else
+			{
+				ui->statusBar->showMessage(tr("Couldn't save %1").arg(saveFileStr));
+			}
 		}
 	}
 }
@@ -111,7 +214,7 @@ void MapGeneratorWindow::onGenerateMapButtonPressed()
 	3. once validation has been passed call the correct generation method
 	*/
 
-	if (!validateInputs())
+	if (isGenerating() || !validateInputs())
 	{
 		return;
 	}
@@ -119,6 +222,7 @@ void MapGeneratorWindow::onGenerateMapButtonPressed()
 	// clear the output label pixel map
 	QPixmap defaultMap(10, 10);
 	ui->label_outputMap->setPixmap(defaultMap);
+	m_outputImage = QImage();
 
 	if (ui->comboBox_outputMapType->currentText().toStdString() == "Normal Map")
 	{
@@ -127,7 +231,7 @@ void MapGeneratorWindow::onGenerateMapButtonPressed()
 		{
 			ampVal = ui->lineEdit_bumpAmp->text().toFloat();
 		}
-		generateNormalMap(ampVal);
+		generateNormalMap(ampVal, selectedBorderMode(), selectedStencil());
 	}
 	else if (ui->comboBox_outputMapType->currentText().toStdString() == "Edge Map")
 	{
@@ -140,6 +244,51 @@ void MapGeneratorWindow::onGenerateMapButtonPressed()
 	}
 }
 
+void MapGeneratorWindow::onBumpAmpEdited()
+{
+	// once the gradients are cached a new amplitude is a single quick pass, so show it straight away
+	if (!isGenerating() && !m_inputGradients.isEmpty() && m_inputGradients.border() == selectedBorderMode()
+		&& m_inputGradients.stencil() == selectedStencil() && ui->comboBox_outputMapType->currentText().toStdString() == "Normal Map")
+	{
+		onGenerateMapButtonPressed();
+	}
+}
+
+MapGen::BorderMode MapGeneratorWindow::selectedBorderMode() const
+{
+	return static_cast<MapGen::BorderMode>(ui->comboBox_borderMode->currentData().toInt());
+}
+
+MapGen::GradientStencil MapGeneratorWindow::selectedStencil() const
+{
+	return static_cast<MapGen::GradientStencil>(ui->comboBox_stencil->currentData().toInt());
+}
+
+void MapGeneratorWindow::onCancelGeneration()
+{
+	if (isGenerating())
+	{
+		m_generationTask->cancel();
+	}
+}
+
+void MapGeneratorWindow::onGenerationFinished(QImage generatedMap, bool cancelled, QString stageSummary)
+{
+	endGeneration();
+	setGenerating(false);
+
+	if (!cancelled)
+	{
+		m_outputImage = generatedMap;
+		showPreview(ui->label_outputMap, m_outputImage);
+		ui->statusBar->showMessage(stageSummary);
+	}
+	else
+	{
+		ui->statusBar->showMessage(tr("Cancelled"));
+	}
+}
+
 void MapGeneratorWindow::onEdgeMapPrimaryColour()
 {
 	QPalette primaryColourPal = ui->pushButton_edgeMapPrimaryColour->palette();
@@ -198,19 +347,47 @@ bool MapGeneratorWindow::validateInputMapCorrectForOutput()
 	return false;
 }
 
+bool MapGeneratorWindow::openRawHeightMap(const QString & fileName, MapGen::RawHeightFormat format, MapGen::StageTimings & timings)
+{
+	// raw files don't say how big they are, so only square ones can be opened here
+	MapGen::RawHeightMap rawHeights;
+	bool opened;
+	{
+		MapGen::StageTimer timer(&timings, "map");
+		opened = rawHeights.open(QFile::encodeName(fileName).toStdString(), format);
+	}
+	if (!opened)
+	{
+		QMessageBox::warning(this, tr("Raw height map"), tr("Couldn't open %1, raw height maps need to be square.").arg(fileName));
+		return false;
+	}
+
+	// the cached heights & gradients belong to the old map, & a new map is rarely the same size so the
+	// blocks they were in aren't worth keeping
+	m_inputHeights.clear();
+	m_inputGradients.clear();
+	MapGen::BufferPool::defaultPool().trim();
+
+	// the heights are read straight out of the mapping, which can go once they're cached. the
+	// greyscale picture of them stands in as the input image for edge maps
+	MapGen::GenerationControl control;
+	control.setStageTimings(&timings);
+	m_inputHeights.build(rawHeights.view(), &MapGen::ThreadPool::defaultPool(), &control);
+
+	MapGen::StageTimer timer(&timings, "preview");
+	m_inputImage = MapGenerators::heightFieldPreview(m_inputHeights);
+	showPreview(ui->label_inputMap, m_inputImage);
+	ui->comboBox_inputMapType->setCurrentText("Height Map");
+	return true;
+}
+
 void MapGeneratorWindow::generateEdgeMap(int sensitivity)
 {
 	// clear the current output map
 	ui->label_outputMap->clear();
 
-	const QPixmap * inputPixelMap = ui->label_inputMap->pixmap();
-	
-	const QImage originalImage = inputPixelMap->toImage();
-
-	QImage generatedMap(originalImage);
-
-	size_t originalImageWidth = originalImage.width(),
-		originalImageHeight = originalImage.height();
+	// QImage copies share the pixels, so handing the input to the worker doesn't copy it
+	const QImage originalImage = m_inputImage;
 
  	QColor btnPrimaryColour = ui->pushButton_edgeMapPrimaryColour->palette().color(QPalette::ColorRole::Button);
 	QColor btnEdgeColour = ui->pushButton_edgeMapEdgeColour->palette().color(QPalette::ColorRole::Button);
@@ -218,191 +395,129 @@ void MapGeneratorWindow::generateEdgeMap(int sensitivity)
 	btnPrimaryColour = btnPrimaryColour.toRgb();
 	btnEdgeColour = btnEdgeColour.toRgb();
 
-	QRgb primaryColour = qRgb(btnPrimaryColour.red(), btnPrimaryColour.green(), btnPrimaryColour.blue());
-	QRgb edgeColour = qRgb(btnEdgeColour.red(), btnEdgeColour.green(), btnEdgeColour.blue());
+	MapGen::EdgeMapSettings settings;
+	settings.detector = static_cast<MapGen::EdgeDetector>(ui->comboBox_edgeDetector->currentData().toInt());
+	settings.sensitivity = sensitivity;
+	settings.primaryColour = qRgb(btnPrimaryColour.red(), btnPrimaryColour.green(), btnPrimaryColour.blue());
+	settings.edgeColour = qRgb(btnEdgeColour.red(), btnEdgeColour.green(), btnEdgeColour.blue());
 
-	for (size_t i = 0; i < originalImageWidth; ++i)
+	startGeneration([originalImage, settings](MapGen::GenerationControl & control)
 	{
-		for (size_t j = 0; j < originalImageHeight; ++j)
-		{
-			generatedMap.setPixelColor(i, j, primaryColour);
-		}
-	}
+		MapGen::EdgeMapSettings controlledSettings = settings;
+		controlledSettings.control = &control;
+		return MapGenerators::generateEdgeMap(originalImage, controlledSettings, &MapGen::ThreadPool::defaultPool());
+	}, originalImage.height());
+}
 
-	
-	// refactor to use the matrix approach later
-	
-	// now run the edge detection step
-	
-	// vertical scan
-	for (size_t x = 0; x < originalImageWidth; ++x)
+void MapGeneratorWindow::generateNormalMap(float amplertude, MapGen::BorderMode border, MapGen::GradientStencil stencil)
+{
+	// QImage copies share the pixels, so handing the input to the worker doesn't copy it
+	QImage originalImage;
+	long long totalRows = 0;
+
+	// the border & stencil are baked into the gradients, so different ones mean building them again
+	if (!m_inputGradients.isEmpty() && (m_inputGradients.border() != border || m_inputGradients.stencil() != stencil))
 	{
-		for (size_t y = 1; y < originalImageHeight; ++y)
-		{
-			// if it's an edge set the pixel to the edge colour
-			const QRgb lastPx = originalImage.pixel(x, y - 1);
-			const QRgb currentPx = originalImage.pixel(x, y);
+		m_inputGradients.clear();
+	}
 
-			int diff = difference(lastPx, currentPx);
+	if (m_inputHeights.isEmpty())
+	{
+		originalImage = m_inputImage;
+		totalRows += originalImage.height();
+	}
 
-			if (diff > sensitivity)
-			{
-				generatedMap.setPixelColor(x, y, edgeColour);
-			}
-		}
+	const long long mapHeight = m_inputHeights.isEmpty() ? originalImage.height() : m_inputHeights.height();
+	if (m_inputGradients.isEmpty())
+	{
+		totalRows += mapHeight;
 	}
+	totalRows += mapHeight;
 
-	// horisontal scan
-	for (size_t y = 0; y < originalImageHeight; ++y)
+	startGeneration([this, originalImage, amplertude, border, stencil](MapGen::GenerationControl & control)
 	{
-		for (size_t x = 1; x < originalImageWidth; ++x)
+		MapGen::ThreadPool & threadPool = MapGen::ThreadPool::defaultPool();
+
+		// a cancelled build leaves the cache empty, so it just gets built again next time
+		if (m_inputHeights.isEmpty())
 		{
-			// if it's an edge set the pixel to the edge colour
-			const QRgb lastPx = originalImage.pixel(x - 1, y);
-			const QRgb currentPx = originalImage.pixel(x, y);
+			MapGenerators::buildHeightField(originalImage, m_inputHeights, &threadPool, &control);
+		}
 
-			int diff = difference(lastPx, currentPx);
+		if (m_inputGradients.isEmpty() && !control.isCancelled())
+		{
+			m_inputGradients.build(m_inputHeights, border, stencil, &threadPool, &control);
+		}
 
-			if (diff > sensitivity)
-			{
-				generatedMap.setPixelColor(x, y, edgeColour);
-			}
+		if (control.isCancelled())
+		{
+			return QImage();
 		}
-	}
 
-	QPixmap outputPixelMap = QPixmap::fromImage(generatedMap);
-	ui->label_outputMap->setPixmap(outputPixelMap);
+		MapGen::NormalMapSettings settings;
+		settings.amplitude = amplertude;
+		settings.control = &control;
+
+		return MapGenerators::generateNormalMap(m_inputGradients, settings, &threadPool);
+	}, totalRows);
 }
 
-void MapGeneratorWindow::generateNormalMap(float amplertude)
+void MapGeneratorWindow::showPreview(QLabel * label, const QImage & image)
 {
-	const QPixmap * inputPixelMap = ui->label_inputMap->pixmap();
-
-	const QImage originalImage = inputPixelMap->toImage();
-
-	QImage generatedMap(originalImage);
-
-	int originalImageWidth = originalImage.width(),
-		originalImageHeight = originalImage.height();
+	// anything bigger than the screen can't be seen all at once anyway, so the label only gets a copy
+	// shrunk to fit rather than a pixmap of the whole thing
+	const QSize screenSize = QGuiApplication::primaryScreen()->availableSize();
 
-	const float imageAspectRatio = (float)originalImageWidth / (float)originalImageHeight;
-
-
-	float heightPxLeftOfCurrent = 0.0f;
-	float heightPxRightOfCurrent = 0.0f;
-	float heightPxUpOfCurrent = 0.0f;
-	float heightPxDownOfCurrent = 0.0f;
-
-	for (int pxPosX = 0; pxPosX < originalImageWidth; ++pxPosX)
+	if (image.width() > screenSize.width() || image.height() > screenSize.height())
 	{
-		for (int pxPosY = 0; pxPosY < originalImageHeight; ++pxPosY)
-		{
-			// 0 everything, the edges will assume 0.0
-			float heightPxLeftOfCurrent = 0.0f;
-			float heightPxRightOfCurrent = 0.0f;
-			float heightPxUpOfCurrent = 0.0f;
-			float heightPxDownOfCurrent = 0.0f;
-
-			// px left
-			if (pxPosX > 0)
-			{
-				heightPxLeftOfCurrent = calcHeightMapPx(originalImage.pixel(pxPosX - 1, pxPosY));
-			}
-
-			// px right
-			if (pxPosX < originalImageWidth - 2)
-			{
-				heightPxRightOfCurrent = calcHeightMapPx(originalImage.pixel(pxPosX + 1, pxPosY));
-			}
-
-			// px up
-			if (pxPosY > 0)
-			{
-				heightPxUpOfCurrent = calcHeightMapPx(originalImage.pixel(pxPosX, pxPosY - 1));
-			}
-
-			// px down
-			if (pxPosY < originalImageHeight- 2)
-			{
-				heightPxRightOfCurrent = calcHeightMapPx(originalImage.pixel(pxPosX, pxPosY + 1));
-			}
-
-			Vector3D s, t;
-			s.x = 1.0f;
-			s.y = 0.0f;
-			// s.z equasion here
-			s.z = amplertude * heightPxRightOfCurrent - amplertude * heightPxLeftOfCurrent;
-
-
-			t.x = 0.0f;
-			t.y = 1.0f;
-			// t.z equasion here
-			t.z = amplertude * heightPxUpOfCurrent - amplertude * heightPxDownOfCurrent;
+		label->setPixmap(QPixmap::fromImage(image.scaled(screenSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+	}
+	else
+	{
+		label->setPixmap(QPixmap::fromImage(image));
+	}
+}
 
-			Vector3D sCrossT = Math::VectorMath::crossProduct(s, t);
-			sCrossT = Math::VectorMath::unitVector(sCrossT);
+void MapGeneratorWindow::startGeneration(MapGenerationTask::Work work, long long totalRows)
+{
+	// both are deleted by endGeneration() & nowhere else
+	m_generationThread = new QThread();
+	m_generationTask = new MapGenerationTask(work, totalRows);
+	m_generationTask->moveToThread(m_generationThread);
 
+	connect(m_generationThread, &QThread::started, m_generationTask, &MapGenerationTask::run);
+	connect(m_generationTask, &MapGenerationTask::progressChanged, ui->progressBar_generation, &QProgressBar::setValue);
+	connect(m_generationTask, &MapGenerationTask::finished, this, &MapGeneratorWindow::onGenerationFinished);
 
-			QRgb valueToStore = vectorToPixel(sCrossT);
-			
-			generatedMap.setPixel(pxPosX, pxPosY, valueToStore);
-		}
-	}
-
-	QPixmap outputPixelMap = QPixmap::fromImage(generatedMap);
-	ui->label_outputMap->setPixmap(outputPixelMap);
+	setGenerating(true);
+	m_generationThread->start();
 }
 
-inline unsigned int MapGeneratorWindow::difference(const QRgb a, const QRgb b)
+void MapGeneratorWindow::endGeneration()
 {
-	int aRed = qRed(a);
-	int aGreen = qGreen(a);
-	int aBlue = qBlue(a);
-
-	int bRed = qRed(b);
-	int bGreen = qGreen(b);
-	int bBlue = qBlue(b);
-
-	int diff = 0;
-	diff += abs(aRed - bRed);
-	diff += abs(aGreen - bGreen);
-	diff += abs(aBlue- bBlue);
-	return diff;
+	// the task's run has returned or will at its next row once cancelled, so the thread only has its event loop left to leave
+	m_generationThread->quit();
+	m_generationThread->wait();
+
+	delete m_generationTask;
+	delete m_generationThread;
+	m_generationTask = nullptr;
+	m_generationThread = nullptr;
 }
 
-inline float MapGeneratorWindow::calcHeightMapPx(const QRgb in)
+bool MapGeneratorWindow::isGenerating() const
 {
-	float height = 0.0f;
-
-	const int max = 255 * 3;
-	float scale = 1.0f / static_cast<float>(max);
-
-	height += static_cast<float>(qRed(in)) * scale;
-	height += static_cast<float>(qGreen(in)) * scale;
-	height += static_cast<float>(qBlue(in)) * scale;
-
-	return height;
+	return m_generationTask != nullptr;
 }
 
-inline QRgb MapGeneratorWindow::vectorToPixel(const Vector3D & in)
+void MapGeneratorWindow::setGenerating(bool generating)
 {
-	float rF, gF, bF;
-	rF = (in.x + 1.0f) / 2.0f;
-	gF = (in.y + 1.0f) / 2.0f;
-	bF = (in.z + 1.0f) / 2.0f;
-
-	// now to convert to range 0-255
-	float finRedComponent, finGreenComponent, finBlueComponent;
-	finRedComponent = rF * 255.0f;
-	finGreenComponent = gF * 255.0f;
-	finBlueComponent = bF * 255.0f;
-
-	// store as int
-	int intRedComp = static_cast<int>(finRedComponent);
-	int intGreenComp = static_cast<int>(finGreenComponent);
-	int intBlueComp = static_cast<int>(finBlueComponent);
-
-	QRgb finalPx = qRgb(intRedComp, intGreenComp, intBlueComp);
-	
-	return finalPx;
-}
\ No newline at end of file
+	ui->progressBar_generation->setValue(0);
+	ui->progressBar_generation->setVisible(generating);
+	ui->pushButton_cancelGeneration->setVisible(generating);
+
+	// the input map & caches can't change under the worker
+	ui->pushButton_generateMap->setDisabled(generating);
+	ui->actionSet_Input_Map->setDisabled(generating);
+	ui->actionSave_Output_Map->setDisabled(generating);
+}
@@ -1,9 +1,19 @@
 #ifndef MAPGENERATORWINDOW_H
 #define MAPGENERATORWINDOW_H
 
+#include <QImage>
 #include <QMainWindow>
 
-#include <JoshMath.h>
+#include "mapgenerationtask.h"
+
+#include <BorderMode.h>
+#include <GradientField.h>
+#include <GradientStencil.h>
+#include <HeightField.h>
+#include <RawHeightMap.h>
+
+class QLabel;
+class QThread;
 
 namespace Ui {
 class MapGeneratorWindow;
@@ -23,6 +33,13 @@ private:
 	void onOpenMap();
 	void onSaveOutputMap();
 	void onGenerateMapButtonPressed();
+	void onBumpAmpEdited();
+	void onCancelGeneration();
+	void onGenerationFinished(QImage generatedMap, bool cancelled, QString stageSummary);
+
+	// border mode & stencil picked in the normal map controls
+	MapGen::BorderMode selectedBorderMode() const;
+	MapGen::GradientStencil selectedStencil() const;
 
 	// pick colour button press handlers
 	void onEdgeMapPrimaryColour();
@@ -33,15 +50,39 @@ private:
 	bool validateInputs();
 	bool validateInputMapCorrectForOutput();
 
+	// maps a raw height file & builds the height cache straight from it, the window shows a greyscale preview
+	bool openRawHeightMap(const QString & fileName, MapGen::RawHeightFormat format, MapGen::StageTimings & timings);
+
 	// generation methods
 	void generateEdgeMap(int sensitivity);
-	void generateNormalMap(float amplertude);
+	void generateNormalMap(float amplertude, MapGen::BorderMode border, MapGen::GradientStencil stencil);
+
+	// shows image in label, shrunk to fit the screen if it's bigger
+	void showPreview(QLabel * label, const QImage & image);
 
-	inline unsigned int difference(const QRgb a, const QRgb b);
-	inline float calcHeightMapPx(const QRgb in);
-	inline QRgb vectorToPixel(const Vector3D & in);
+	// runs work on a worker thread, totalRows is how many rows it'll go through for the progress bar
+	void startGeneration(MapGenerationTask::Work work, long long totalRows);
+	// waits for the generation thread to stop & deletes it & the task
+	void endGeneration();
+	bool isGenerating() const;
+	void setGenerating(bool generating);
 
     Ui::MapGeneratorWindow *ui;
+
+	// the full size input & the last generated map, the labels only show previews of them
+	QImage m_inputImage;
+	QImage m_outputImage;
+
+	// heights of the current input map, built on the first normal map generation & kept until another map is opened
+	MapGen::HeightField m_inputHeights;
+
+	// height differences of the current input map, the amplitude only scales these so changing it just repacks them
+	MapGen::GradientField m_inputGradients;
+
+	// the generation running in the background, both null when there isn't one. the caches above
+	// belong to the worker thread while it runs, so the input map can't be changed until it's done
+	QThread * m_generationThread;
+	MapGenerationTask * m_generationTask;
 };
 
 #endif // MAPGENERATORWINDOW_H
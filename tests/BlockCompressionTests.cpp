@@ -0,0 +1,163 @@
+#include "TestSupport.h"
+
+#include <BlockCompression.h>
+#include <DdsFile.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	using MapGen::Pixel;
+	using MapGenTests::Image;
+
+	uint32_t littleEndian(const unsigned char * p)
+	{
+		return (static_cast<uint32_t>(p[3]) << 24) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[0];
+	}
+
+	// one channel of a BC5 block as the GPU decodes it, the 8 value mode when the first endpoint is bigger
+	void decodeBC4(const unsigned char * block, int * values)
+	{
+		const int first = block[0];
+		const int second = block[1];
+
+		int palette[8] = { first, second };
+		for (int i = 2; i < 8; ++i)
+		{
+			palette[i] = (first > second) ? ((8 - i) * first + (i - 1) * second + 3) / 7
+				: (i < 6 ? ((6 - i) * first + (i - 1) * second + 2) / 5 : (i == 6 ? 0 : 255));
+		}
+
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; ++i)
+		{
+			indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			values[i] = palette[(indices >> (i * 3)) & 7];
+		}
+	}
+
+	// every decoded red & green within half a palette step (& a little rounding) of what went in. the blocks hanging
+	// over the right & bottom edges repeat the last column & row
+	bool bc5Close(const std::vector<unsigned char> & blocks, const Image & original)
+	{
+		const int blocksWide = (original.width + 3) / 4;
+		for (int blockRow = 0; blockRow < (original.height + 3) / 4; ++blockRow)
+		{
+			for (int blockColumn = 0; blockColumn < blocksWide; ++blockColumn)
+			{
+				const unsigned char * block = &blocks[(static_cast<size_t>(blockRow) * blocksWide + blockColumn) * 16];
+				for (int channel = 0; channel < 2; ++channel)
+				{
+					int decoded[16];
+					decodeBC4(block + channel * 8, decoded);
+					const int range = block[channel * 8] - block[channel * 8 + 1];
+
+					for (int i = 0; i < 16; ++i)
+					{
+						const int x = std::min(blockColumn * 4 + i % 4, original.width - 1);
+						const int y = std::min(blockRow * 4 + i / 4, original.height - 1);
+						const Pixel px = original.at(x, y);
+						const int value = channel == 0 ? MapGen::pixelRed(px) : MapGen::pixelGreen(px);
+						if (std::abs(decoded[i] - value) > std::max(0, range) / 14 + 1)
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
+
+// BC5 of a normal map's whole mip chain, the same across the pool as serial, decoding close to the normals & written
+// to a DDS that reads back to the same blocks
+void MapGenTests::testBlockCompression(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+
+	MapGen::HeightField heights;
+	heights.build(input.constView(), &threadPool);
+
+	std::vector<Image> normals;
+	std::vector<MapGen::ImageView> views;
+	const int levelCount = MapGen::mipLevelCount(input.width, input.height);
+	for (int level = 0; level < levelCount; ++level)
+	{
+		normals.emplace_back(MapGen::mipLevelSize(input.width, level), MapGen::mipLevelSize(input.height, level));
+	}
+	for (Image & level : normals)
+	{
+		views.push_back(level.view());
+	}
+	MapGen::generateNormalMapMips(heights, views, MapGen::NormalMapSettings(), threadPool);
+
+	std::vector<std::vector<unsigned char>> levels;
+	bool sameAsSerial = true, close = true;
+	for (const Image & level : normals)
+	{
+		levels.emplace_back(MapGen::bc5Size(level.width, level.height));
+		check(levels.back().size() == static_cast<size_t>((level.width + 3) / 4) * ((level.height + 3) / 4) * 16, size + " bc5 size");
+		MapGen::compressBC5(level.constView(), levels.back().data(), threadPool);
+
+		std::vector<unsigned char> serial(levels.back().size());
+		MapGen::compressBC5(level.constView(), serial.data());
+		sameAsSerial = sameAsSerial && serial == levels.back();
+		close = close && bc5Close(levels.back(), level);
+	}
+	check(sameAsSerial, size + " bc5 across the pool same as serial");
+	check(close, size + " bc5 decodes close to the normals");
+
+	// a block of one colour decodes exactly
+	Image flat(input.width, input.height);
+	std::fill(flat.pixels.begin(), flat.pixels.end(), MapGen::makePixel(200, 17, 255));
+	std::vector<unsigned char> flatBlocks(MapGen::bc5Size(flat.width, flat.height));
+	MapGen::compressBC5(flat.constView(), flatBlocks.data());
+	bool exact = true;
+	for (size_t block = 0; block < flatBlocks.size(); block += 8)
+	{
+		int decoded[16];
+		decodeBC4(&flatBlocks[block], decoded);
+		const int expected = (block / 8) % 2 == 0 ? 200 : 17;
+		exact = exact && std::all_of(decoded, decoded + 16, [expected](int value) { return value == expected; });
+	}
+	check(exact, size + " bc5 of a flat image decodes exactly");
+
+	const std::string path = "ImageMapGenTests.dds";
+	check(MapGen::writeDdsBC5(path, input.width, input.height, levels), size + " dds written");
+	const std::vector<unsigned char> dds = readFile(path);
+	std::remove(path.c_str());
+
+	size_t payloadBytes = 0;
+	for (const std::vector<unsigned char> & level : levels)
+	{
+		payloadBytes += level.size();
+	}
+
+	// the magic, the 124 byte header & the 20 byte DX10 one before the levels one after another
+	const size_t headerBytes = 4 + 124 + 20;
+	const bool headerRead = dds.size() == headerBytes + payloadBytes
+		&& dds[0] == 'D' && dds[1] == 'D' && dds[2] == 'S' && dds[3] == ' '
+		&& littleEndian(&dds[4]) == 124
+		&& littleEndian(&dds[12]) == static_cast<uint32_t>(input.height)
+		&& littleEndian(&dds[16]) == static_cast<uint32_t>(input.width)
+		&& littleEndian(&dds[20]) == levels[0].size()
+		&& littleEndian(&dds[28]) == static_cast<uint32_t>(levelCount)
+		&& dds[84] == 'D' && dds[85] == 'X' && dds[86] == '1' && dds[87] == '0'
+		&& littleEndian(&dds[128]) == 83 // DXGI_FORMAT_BC5_UNORM
+		&& littleEndian(&dds[140]) == 1;
+	check(headerRead, size + " dds header");
+
+	bool sameBlocks = headerRead;
+	size_t at = headerBytes;
+	for (const std::vector<unsigned char> & level : levels)
+	{
+		sameBlocks = sameBlocks && std::equal(level.begin(), level.end(), dds.begin() + at);
+		at += level.size();
+	}
+	check(sameBlocks, size + " dds reads back the same blocks");
+}
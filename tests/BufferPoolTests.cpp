@@ -0,0 +1,48 @@
+#include "TestSupport.h"
+
+#include <BufferPool.h>
+
+#include <cstdint>
+
+// blocks are aligned, kept when given back & reused for sizes close enough, & a height field built into reused blocks
+// full of the last map's planes gives the same normals as a fresh one
+void MapGenTests::testBufferPool()
+{
+	MapGen::BufferPool pool(1 << 20);
+
+	unsigned char * first;
+	{
+		MapGen::PooledBuffer buffer = pool.acquire(1000);
+		first = buffer.data();
+		check(reinterpret_cast<uintptr_t>(first) % MapGen::BufferPool::alignment == 0, "pooled buffers are aligned");
+	}
+	check(pool.keptBytes() == 1000, "buffer kept once given back");
+
+	MapGen::PooledBuffer reused = pool.acquire(900);
+	check(reused.data() == first && reused.size() == 900, "kept buffer reused for a similar size");
+	MapGen::PooledBuffer fresh = pool.acquire(100);
+	check(fresh.data() != first, "kept buffer not reused for a much smaller size");
+
+	MapGen::PooledBuffer moved = std::move(reused);
+	check(reused.isEmpty() && moved.data() == first, "pooled buffers move");
+	moved.reset();
+	fresh.reset();
+
+	{
+		MapGen::PooledBuffer tooBig = pool.acquire(2 << 20);
+	}
+	check(pool.keptBytes() == 1100, "buffers bigger than the pool keeps are freed");
+	pool.trim();
+	check(pool.keptBytes() == 0, "trim frees everything kept");
+
+	const Image firstMap = makeHeightImage(67, 31, 3);
+	const Image secondMap = makeHeightImage(67, 31, 4);
+	MapGen::HeightField heights;
+	heights.build(firstMap.constView(), nullptr);
+	heights.clear();
+	heights.build(secondMap.constView(), nullptr);
+
+	Image output(secondMap.width, secondMap.height);
+	MapGen::generateNormalMap(heights, output.view(), MapGen::NormalMapSettings());
+	checkSame(output, referenceNormalMap(heightsOf(secondMap), MapGen::NormalMapSettings()), "height field rebuilt into pooled blocks");
+}
@@ -0,0 +1,114 @@
+#include "TestSupport.h"
+
+#include <cstdlib>
+
+namespace
+{
+	using MapGenTests::Image;
+
+	// an edge where the summed RGB differs by more than the sensitivity from the pixel to the left or the one above
+	Image referenceDifferenceEdges(const Image & image, const MapGen::EdgeMapSettings & settings)
+	{
+		Image out(image.width, image.height);
+		for (int y = 0; y < image.height; ++y)
+		{
+			for (int x = 0; x < image.width; ++x)
+			{
+				const bool left = x > 0 && static_cast<int>(MapGen::difference(image.at(x - 1, y), image.at(x, y))) > settings.sensitivity;
+				const bool above = y > 0 && static_cast<int>(MapGen::difference(image.at(x, y - 1), image.at(x, y))) > settings.sensitivity;
+				out.pixel(x, y) = (left || above) ? settings.edgeColour : settings.primaryColour;
+			}
+		}
+		return out;
+	}
+
+	// the 3x3 Sobel over the summed RGB with the edge pixels repeated, an edge where |gx| + |gy| is more than 4 times the
+	// sensitivity, the weight of the kernel's centre row
+	Image referenceSobelEdges(const Image & image, const MapGen::EdgeMapSettings & settings)
+	{
+		auto intensity = [&image](int x, int y)
+		{
+			const MapGen::Pixel px = image.at(std::min(std::max(x, 0), image.width - 1), std::min(std::max(y, 0), image.height - 1));
+			return MapGen::pixelRed(px) + MapGen::pixelGreen(px) + MapGen::pixelBlue(px);
+		};
+
+		Image out(image.width, image.height);
+		for (int y = 0; y < image.height; ++y)
+		{
+			for (int x = 0; x < image.width; ++x)
+			{
+				const int gx = (intensity(x + 1, y - 1) - intensity(x - 1, y - 1)) + 2 * (intensity(x + 1, y) - intensity(x - 1, y))
+					+ (intensity(x + 1, y + 1) - intensity(x - 1, y + 1));
+				const int gy = (intensity(x - 1, y + 1) + 2 * intensity(x, y + 1) + intensity(x + 1, y + 1))
+					- (intensity(x - 1, y - 1) + 2 * intensity(x, y - 1) + intensity(x + 1, y - 1));
+				out.pixel(x, y) = (std::abs(gx) + std::abs(gy) > settings.sensitivity * 4) ? settings.edgeColour : settings.primaryColour;
+			}
+		}
+		return out;
+	}
+
+	struct Detector
+	{
+		MapGen::EdgeDetector detector;
+		const char * name;
+		Image (*reference)(const Image & image, const MapGen::EdgeMapSettings & settings);
+	};
+
+	const Detector detectors[] =
+	{
+		{ MapGen::EdgeDetector::Difference, "difference", referenceDifferenceEdges },
+		{ MapGen::EdgeDetector::Sobel, "sobel", referenceSobelEdges },
+		{ MapGen::EdgeDetector::Canny, "canny", nullptr }
+	};
+}
+
+// each detector against its per pixel version where it has one, & serial against across the pool
+void MapGenTests::testEdgeMaps(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+
+	for (const Detector & detector : detectors)
+	{
+		for (int sensitivity : { 10, 50, 200 })
+		{
+			MapGen::EdgeMapSettings settings;
+			settings.detector = detector.detector;
+			settings.sensitivity = sensitivity;
+			settings.primaryColour = 0xff102030;
+			settings.edgeColour = 0xffe0d0c0;
+
+			const std::string name = size + " " + detector.name + " edges sensitivity " + std::to_string(sensitivity);
+
+			Image serial(input.width, input.height);
+			check(MapGen::generateEdgeMap(input.constView(), serial.view(), settings), name + " generated");
+			if (detector.reference)
+			{
+				checkSame(serial, detector.reference(input, settings), name);
+			}
+
+			Image output(input.width, input.height);
+			MapGen::generateEdgeMap(input.constView(), output.view(), settings, threadPool);
+			checkSame(output, serial, name + " across the pool");
+
+			bool twoColours = true;
+			for (Pixel px : serial.pixels)
+			{
+				twoColours = twoColours && (px == settings.primaryColour || px == settings.edgeColour);
+			}
+			check(twoColours, name + " only the two colours");
+		}
+
+		// nothing in a flat image is an edge
+		Image flat(input.width, input.height);
+		std::fill(flat.pixels.begin(), flat.pixels.end(), MapGen::makePixel(90, 90, 90));
+
+		MapGen::EdgeMapSettings settings;
+		settings.detector = detector.detector;
+		settings.sensitivity = 0;
+
+		Image output(flat.width, flat.height);
+		MapGen::generateEdgeMap(flat.constView(), output.view(), settings, threadPool);
+		check(std::all_of(output.pixels.begin(), output.pixels.end(), [&](Pixel px) { return px == settings.primaryColour; }),
+			size + " " + detector.name + " flat image has no edges");
+	}
+}
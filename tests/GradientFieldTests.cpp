@@ -0,0 +1,39 @@
+#include "TestSupport.h"
+
+// gradients built once & packed again for each amplitude give the same normal map as generating it from scratch
+void MapGenTests::testGradientField(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+	const HeightGrid grid = heightsOf(input);
+
+	MapGen::HeightField heights;
+	heights.build(input.constView(), &threadPool);
+
+	for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+	{
+		const std::string name = size + " " + settingsName(settings);
+
+		MapGen::GradientField gradients, pooledGradients;
+		check(gradients.build(heights, settings.border, settings.stencil, nullptr), name + " gradient field built");
+		check(pooledGradients.build(heights, settings.border, settings.stencil, &threadPool), name + " gradient field built across the pool");
+		check(gradients.width() == input.width && gradients.height() == input.height
+			&& gradients.border() == settings.border && gradients.stencil() == settings.stencil, name + " gradient field keeps its size, border & stencil");
+
+		const Image expected = referenceNormalMap(grid, settings);
+		Image output(input.width, input.height);
+
+		MapGen::generateNormalMap(gradients, output.view(), settings);
+		checkSame(output, expected, name + " gradient field");
+		output.clear();
+		MapGen::generateNormalMap(pooledGradients, output.view(), settings, threadPool);
+		checkSame(output, expected, name + " gradient field across the pool");
+
+		// the border & stencil come from the gradients, whatever the settings say
+		MapGen::NormalMapSettings otherSettings = settings;
+		otherSettings.border = settings.border == MapGen::BorderMode::Zero ? MapGen::BorderMode::Clamp : MapGen::BorderMode::Zero;
+		otherSettings.stencil = settings.stencil == MapGen::GradientStencil::Sobel ? MapGen::GradientStencil::Prewitt : MapGen::GradientStencil::Sobel;
+		output.clear();
+		MapGen::generateNormalMap(gradients, output.view(), otherSettings, threadPool);
+		checkSame(output, expected, name + " gradient field ignores the settings' border & stencil");
+	}
+}
@@ -0,0 +1,42 @@
+#include "TestSupport.h"
+
+// the kept heights are exactly calcHeightMapPx of each pixel, & normal maps from them match the ones from the image
+void MapGenTests::testHeightField(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+	const HeightGrid grid = heightsOf(input);
+
+	MapGen::HeightField heights;
+	check(heights.isEmpty(), size + " height field starts empty");
+	check(heights.build(input.constView(), nullptr), size + " height field built");
+	MapGen::HeightField pooledHeights;
+	check(pooledHeights.build(input.constView(), &threadPool), size + " height field built across the pool");
+
+	bool sameHeights = heights.width() == input.width && heights.height() == input.height
+		&& pooledHeights.width() == input.width && pooledHeights.height() == input.height;
+	for (int y = 0; sameHeights && y < input.height; ++y)
+	{
+		for (int x = 0; x < input.width; ++x)
+		{
+			const float expected = grid.heights[static_cast<size_t>(y) * input.width + x];
+			sameHeights = sameHeights && heights.row(y)[x] == expected && pooledHeights.row(y)[x] == expected;
+		}
+	}
+	check(sameHeights, size + " height field holds each pixel's height");
+
+	for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+	{
+		const std::string name = size + " " + settingsName(settings);
+		const Image expected = referenceNormalMap(grid, settings);
+		Image output(input.width, input.height);
+
+		MapGen::generateNormalMap(heights, output.view(), settings);
+		checkSame(output, expected, name + " height field");
+		output.clear();
+		MapGen::generateNormalMap(pooledHeights, output.view(), settings, threadPool);
+		checkSame(output, expected, name + " height field across the pool");
+	}
+
+	heights.clear();
+	check(heights.isEmpty() && heights.width() == 0 && heights.height() == 0, size + " height field cleared");
+}
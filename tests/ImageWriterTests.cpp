@@ -0,0 +1,280 @@
+#include "TestSupport.h"
+
+#include <PngFile.h>
+#include <QoiFile.h>
+
+#ifdef MAPGEN_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	using MapGen::Pixel;
+	using MapGen::pixelBlue;
+	using MapGen::pixelGreen;
+	using MapGen::pixelRed;
+	using MapGenTests::Image;
+
+	uint32_t bigEndian(const unsigned char * p)
+	{
+		return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+	}
+
+	// the pixels that went in, or with alpha dropped made opaque like a 3 channel file reads back
+	bool samePixels(const Image & decoded, const Image & original, bool alpha)
+	{
+		if (decoded.width != original.width || decoded.height != original.height)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < original.pixels.size(); ++i)
+		{
+			const Pixel expected = alpha ? original.pixels[i] : (original.pixels[i] | 0xff000000);
+			if (decoded.pixels[i] != expected)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// a QOI decoder straight from the spec
+	bool readQoi(const std::vector<unsigned char> & file, Image & image)
+	{
+		if (file.size() < 22 || file[0] != 'q' || file[1] != 'o' || file[2] != 'i' || file[3] != 'f')
+		{
+			return false;
+		}
+
+		image = Image(static_cast<int>(bigEndian(&file[4])), static_cast<int>(bigEndian(&file[8])));
+		const int channels = file[12];
+		if (channels != 3 && channels != 4)
+		{
+			return false;
+		}
+
+		Pixel seen[64] = {};
+		int red = 0, green = 0, blue = 0, alpha = 255;
+		size_t at = 14;
+		const size_t end = file.size() - 8;
+
+		for (size_t i = 0; i < image.pixels.size();)
+		{
+			if (at >= end)
+			{
+				return false;
+			}
+
+			const unsigned char op = file[at++];
+			int run = 1;
+			if (op == 0xfe)
+			{
+				red = file[at];
+				green = file[at + 1];
+				blue = file[at + 2];
+				at += 3;
+			}
+			else if (op == 0xff)
+			{
+				red = file[at];
+				green = file[at + 1];
+				blue = file[at + 2];
+				alpha = file[at + 3];
+				at += 4;
+			}
+			else if ((op >> 6) == 0)
+			{
+				const Pixel px = seen[op];
+				red = pixelRed(px);
+				green = pixelGreen(px);
+				blue = pixelBlue(px);
+				alpha = static_cast<int>(px >> 24);
+			}
+			else if ((op >> 6) == 1)
+			{
+				red = (red + ((op >> 4) & 3) - 2) & 0xff;
+				green = (green + ((op >> 2) & 3) - 2) & 0xff;
+				blue = (blue + (op & 3) - 2) & 0xff;
+			}
+			else if ((op >> 6) == 2)
+			{
+				const int greenDifference = (op & 0x3f) - 32;
+				const unsigned char next = file[at++];
+				red = (red + greenDifference + (next >> 4) - 8) & 0xff;
+				green = (green + greenDifference) & 0xff;
+				blue = (blue + greenDifference + (next & 0xf) - 8) & 0xff;
+			}
+			else
+			{
+				run = (op & 0x3f) + 1;
+			}
+
+			const Pixel px = (static_cast<Pixel>(alpha) << 24) | (static_cast<Pixel>(red) << 16) | (static_cast<Pixel>(green) << 8) | static_cast<Pixel>(blue);
+			seen[(red * 3 + green * 5 + blue * 7 + alpha * 11) % 64] = px;
+			for (; run > 0 && i < image.pixels.size(); --run)
+			{
+				image.pixels[i++] = px;
+			}
+		}
+
+		// the end marker, seven 0s & a 1
+		static const unsigned char endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		return at == end && std::equal(endMarker, endMarker + 8, file.begin() + end);
+	}
+
+#ifdef MAPGEN_HAVE_ZLIB
+	int paeth(int left, int above, int aboveLeft)
+	{
+		const int estimate = left + above - aboveLeft;
+		const int toLeft = std::abs(estimate - left);
+		const int toAbove = std::abs(estimate - above);
+		const int toAboveLeft = std::abs(estimate - aboveLeft);
+		if (toLeft <= toAbove && toLeft <= toAboveLeft)
+		{
+			return left;
+		}
+		return toAbove <= toAboveLeft ? above : aboveLeft;
+	}
+
+	// an 8 bit RGB or RGBA PNG, checking every chunk's CRC & undoing all five filters
+	bool readPng(const std::vector<unsigned char> & file, Image & image)
+	{
+		static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		if (file.size() < 8 || !std::equal(signature, signature + 8, file.begin()))
+		{
+			return false;
+		}
+
+		int channels = 0;
+		std::vector<unsigned char> compressed;
+		bool ended = false;
+		for (size_t at = 8; at + 12 <= file.size() && !ended;)
+		{
+			const uint32_t length = bigEndian(&file[at]);
+			if (at + 12 + length > file.size())
+			{
+				return false;
+			}
+
+			const unsigned char * type = &file[at + 4];
+			const unsigned char * data = &file[at + 8];
+			if (bigEndian(data + length) != crc32(0, type, length + 4))
+			{
+				return false;
+			}
+
+			const std::string name(reinterpret_cast<const char *>(type), 4);
+			if (name == "IHDR")
+			{
+				image = Image(static_cast<int>(bigEndian(data)), static_cast<int>(bigEndian(data + 4)));
+				if (data[8] != 8 || (data[9] != 2 && data[9] != 6) || data[12] != 0)
+				{
+					return false;
+				}
+				channels = data[9] == 6 ? 4 : 3;
+			}
+			else if (name == "IDAT")
+			{
+				compressed.insert(compressed.end(), data, data + length);
+			}
+			else if (name == "IEND")
+			{
+				ended = true;
+			}
+			at += 12 + length;
+		}
+		if (!ended || channels == 0)
+		{
+			return false;
+		}
+
+		const size_t rowBytes = static_cast<size_t>(image.width) * channels;
+		std::vector<unsigned char> filtered((rowBytes + 1) * image.height);
+		uLongf filteredSize = static_cast<uLongf>(filtered.size());
+		if (uncompress(filtered.data(), &filteredSize, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK || filteredSize != filtered.size())
+		{
+			return false;
+		}
+
+		std::vector<unsigned char> previous(rowBytes, 0), current(rowBytes);
+		for (int y = 0; y < image.height; ++y)
+		{
+			const unsigned char * line = &filtered[y * (rowBytes + 1)];
+			const int filter = line[0];
+			for (size_t i = 0; i < rowBytes; ++i)
+			{
+				const int left = i >= static_cast<size_t>(channels) ? current[i - channels] : 0;
+				const int aboveLeft = i >= static_cast<size_t>(channels) ? previous[i - channels] : 0;
+				int predicted;
+				switch (filter)
+				{
+				case 0:
+					predicted = 0;
+					break;
+				case 1:
+					predicted = left;
+					break;
+				case 2:
+					predicted = previous[i];
+					break;
+				case 3:
+					predicted = (left + previous[i]) / 2;
+					break;
+				case 4:
+					predicted = paeth(left, previous[i], aboveLeft);
+					break;
+				default:
+					return false;
+				}
+				current[i] = static_cast<unsigned char>(line[i + 1] + predicted);
+			}
+
+			for (int x = 0; x < image.width; ++x)
+			{
+				const unsigned char * px = &current[x * channels];
+				image.pixel(x, y) = (static_cast<Pixel>(channels == 4 ? px[3] : 255) << 24) | (static_cast<Pixel>(px[0]) << 16)
+					| (static_cast<Pixel>(px[1]) << 8) | px[2];
+			}
+			previous.swap(current);
+		}
+		return true;
+	}
+#endif
+}
+
+// files written from the image read back to the same pixels, with or without alpha & at every compression level
+void MapGenTests::testImageWriters(const Image & image, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(image);
+
+	const std::string qoiPath = "ImageMapGenTests.qoi";
+	for (bool alpha : { false, true })
+	{
+		const std::string name = size + " qoi " + (alpha ? "rgba" : "rgb");
+		check(MapGen::writeQoi(qoiPath, image.constView(), alpha), name + " written");
+		Image decoded(0, 0);
+		check(readQoi(readFile(qoiPath), decoded) && samePixels(decoded, image, alpha), name + " reads back the same");
+	}
+	std::remove(qoiPath.c_str());
+
+#ifdef MAPGEN_HAVE_ZLIB
+	check(MapGen::pngWriterAvailable(), "png writer built with zlib");
+	const std::string pngPath = "ImageMapGenTests.png";
+	for (int level : { 0, 1, 6, 9 })
+	{
+		for (bool alpha : { false, true })
+		{
+			const std::string name = size + " png level " + std::to_string(level) + (alpha ? " rgba" : " rgb");
+			check(MapGen::writePng(pngPath, image.constView(), alpha, level, threadPool), name + " written");
+			Image decoded(0, 0);
+			check(readPng(readFile(pngPath), decoded) && samePixels(decoded, image, alpha), name + " reads back the same");
+		}
+	}
+	std::remove(pngPath.c_str());
+#else
+	check(!MapGen::pngWriterAvailable() && !MapGen::writePng("ImageMapGenTests.png", image.constView(), false, 6, threadPool), "png writer fails without zlib");
+#endif
+}
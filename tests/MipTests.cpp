@@ -0,0 +1,74 @@
+#include "TestSupport.h"
+
+#include <cmath>
+
+namespace
+{
+	using MapGenTests::HeightGrid;
+
+	// each height the average of the 2x2 it covers, the last row & column repeated when the size is odd
+	HeightGrid halfSize(const HeightGrid & larger)
+	{
+		HeightGrid half = { std::max(1, larger.width / 2), std::max(1, larger.height / 2), {} };
+		half.heights.resize(static_cast<size_t>(half.width) * half.height);
+		auto at = [&larger](int x, int y)
+		{
+			return larger.heights[static_cast<size_t>(std::min(y, larger.height - 1)) * larger.width + std::min(x, larger.width - 1)];
+		};
+
+		for (int y = 0; y < half.height; ++y)
+		{
+			for (int x = 0; x < half.width; ++x)
+			{
+				half.heights[static_cast<size_t>(y) * half.width + x] = ((at(x * 2, y * 2) + at(x * 2 + 1, y * 2))
+					+ (at(x * 2, y * 2 + 1) + at(x * 2 + 1, y * 2 + 1))) * 0.25f;
+			}
+		}
+		return half;
+	}
+}
+
+// every level is the per pixel normal map of the heights averaged down to its size, with the amplitude halved per level
+void MapGenTests::testMips(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+
+	const int levelCount = MapGen::mipLevelCount(input.width, input.height);
+	const int largest = std::max(input.width, input.height);
+	check(levelCount == static_cast<int>(std::floor(std::log2(static_cast<double>(largest)))) + 1, size + " mip level count");
+	check(MapGen::mipLevelSize(input.width, levelCount - 1) == 1 && MapGen::mipLevelSize(input.height, levelCount - 1) == 1, size + " mip chain ends at 1x1");
+
+	std::vector<HeightGrid> grids(1, heightsOf(input));
+	for (int level = 1; level < levelCount; ++level)
+	{
+		grids.push_back(halfSize(grids.back()));
+		check(grids.back().width == MapGen::mipLevelSize(input.width, level) && grids.back().height == MapGen::mipLevelSize(input.height, level),
+			size + " mip level " + std::to_string(level) + " size");
+	}
+
+	MapGen::HeightField heights;
+	heights.build(input.constView(), &threadPool);
+
+	for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+	{
+		std::vector<Image> levels;
+		for (const HeightGrid & grid : grids)
+		{
+			levels.emplace_back(grid.width, grid.height);
+		}
+		std::vector<MapGen::ImageView> views;
+		for (Image & level : levels)
+		{
+			views.push_back(level.view());
+		}
+
+		const std::string name = size + " " + settingsName(settings) + " mip level ";
+		check(MapGen::generateNormalMapMips(heights, views, settings, threadPool), name + "chain generated");
+		for (int level = 0; level < levelCount; ++level)
+		{
+			MapGen::NormalMapSettings levelSettings = settings;
+			levelSettings.amplitude = std::ldexp(settings.amplitude, -level);
+			checkSame(levels[level], referenceNormalMap(grids[level], levelSettings), name + std::to_string(level));
+		}
+	}
+}
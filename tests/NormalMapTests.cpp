@@ -0,0 +1,28 @@
+#include "TestSupport.h"
+
+// the image overloads, serial & across the pool, against the per pixel maths. the SIMD kernels have to give exactly
+// the same pixels, except with the approximate reciprocal square root which can be one out
+void MapGenTests::testNormalMapOverloads(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const HeightGrid grid = heightsOf(input);
+
+	for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+	{
+		const std::string name = sizeName(input) + " " + settingsName(settings);
+		const Image expected = referenceNormalMap(grid, settings);
+		Image output(input.width, input.height);
+
+		check(MapGen::generateNormalMap(input.constView(), output.view(), settings), name + " image generated");
+		checkSame(output, expected, name + " image");
+		output.clear();
+		check(MapGen::generateNormalMap(input.constView(), output.view(), settings, threadPool), name + " image generated across the pool");
+		checkSame(output, expected, name + " image across the pool");
+
+		MapGen::NormalMapSettings fastSettings = settings;
+		fastSettings.fastNormalise = true;
+		MapGen::generateNormalMap(input.constView(), output.view(), fastSettings);
+		check(largestChannelDifference(output, expected) <= 1, name + " fast normalise within one");
+		MapGen::generateNormalMap(input.constView(), output.view(), fastSettings, threadPool);
+		check(largestChannelDifference(output, expected) <= 1, name + " fast normalise across the pool within one");
+	}
+}
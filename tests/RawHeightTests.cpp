@@ -0,0 +1,167 @@
+#include "TestSupport.h"
+
+#include <cstdio>
+
+namespace
+{
+	using MapGenTests::HeightGrid;
+	using MapGenTests::Image;
+
+	// samples are little endian whatever the machine is, like the files they come from
+	void appendLittleEndian(std::vector<unsigned char> & bytes, uint16_t sample)
+	{
+		bytes.push_back(static_cast<unsigned char>(sample));
+		bytes.push_back(static_cast<unsigned char>(sample >> 8));
+	}
+
+	// raw samples & the heights they stand for
+	struct RawHeights
+	{
+		std::vector<unsigned char> bytes;
+		HeightGrid grid;
+		MapGen::RawHeightView view;
+	};
+
+	// each pixel's red as a 16 bit sample
+	RawHeights makeR16(const Image & input)
+	{
+		RawHeights raw = { {}, { input.width, input.height, std::vector<float>(input.pixels.size()) }, {} };
+		for (size_t i = 0; i < input.pixels.size(); ++i)
+		{
+			const uint16_t sample = static_cast<uint16_t>(MapGen::pixelRed(input.pixels[i]) * 257 + (i & 0xff));
+			appendLittleEndian(raw.bytes, sample);
+			raw.grid.heights[i] = static_cast<float>(sample) * (1.0f / 65535.0f);
+		}
+		raw.view = MapGen::RawHeightView(raw.bytes.data(), input.width, input.height, input.width * 2, MapGen::RawHeightFormat::R16);
+		return raw;
+	}
+
+	// the height of 16 bit RGBA is the average of red, green & blue, each added in at a third of its 0 - 1 value.
+	// these are fine enough to catch amplitude * right - amplitude * left rounding differently at amplitude 25
+	RawHeights makeRGBA16(const Image & input)
+	{
+		RawHeights raw = { {}, { input.width, input.height, std::vector<float>(input.pixels.size()) }, {} };
+		const float scale = 1.0f / static_cast<float>(65535 * 3);
+		for (size_t i = 0; i < input.pixels.size(); ++i)
+		{
+			const MapGen::Pixel px = input.pixels[i];
+			const uint16_t channels[4] = { static_cast<uint16_t>(MapGen::pixelRed(px) * 257 + 1), static_cast<uint16_t>(MapGen::pixelGreen(px) * 257),
+				static_cast<uint16_t>(MapGen::pixelBlue(px) * 257), 65535 };
+			float height = 0.0f;
+			for (int c = 0; c < 4; ++c)
+			{
+				appendLittleEndian(raw.bytes, channels[c]);
+			}
+			for (int c = 0; c < 3; ++c)
+			{
+				height += static_cast<float>(channels[c]) * scale;
+			}
+			raw.grid.heights[i] = height;
+		}
+		raw.view = MapGen::RawHeightView(raw.bytes.data(), input.width, input.height, input.width * 8, MapGen::RawHeightFormat::RGBA16);
+		return raw;
+	}
+
+	// floats are used as they are, so the image's own heights give exactly its normal map
+	RawHeights makeR32F(const Image & input)
+	{
+		RawHeights raw = { {}, MapGenTests::heightsOf(input), {} };
+		raw.bytes.resize(raw.grid.heights.size() * sizeof(float));
+		std::copy(reinterpret_cast<const unsigned char *>(raw.grid.heights.data()), reinterpret_cast<const unsigned char *>(raw.grid.heights.data()) + raw.bytes.size(), raw.bytes.begin());
+		raw.view = MapGen::RawHeightView(raw.bytes.data(), input.width, input.height, input.width * sizeof(float), MapGen::RawHeightFormat::R32F);
+		return raw;
+	}
+
+	void checkRawOverloads(const RawHeights & raw, const std::string & what, MapGen::ThreadPool & threadPool)
+	{
+		MapGen::HeightField heights;
+		MapGenTests::check(heights.build(raw.view, &threadPool), what + " height field built");
+
+		for (const MapGen::NormalMapSettings & settings : MapGenTests::normalSettingsToCheck())
+		{
+			const std::string name = what + " " + MapGenTests::settingsName(settings);
+			const Image expected = MapGenTests::referenceNormalMap(raw.grid, settings);
+			Image output(raw.view.width, raw.view.height);
+
+			MapGen::generateNormalMap(raw.view, output.view(), settings);
+			MapGenTests::checkSame(output, expected, name);
+			output.clear();
+			MapGen::generateNormalMap(raw.view, output.view(), settings, threadPool);
+			MapGenTests::checkSame(output, expected, name + " across the pool");
+			output.clear();
+			MapGen::generateNormalMap(heights, output.view(), settings, threadPool);
+			MapGenTests::checkSame(output, expected, name + " height field");
+		}
+	}
+}
+
+void MapGenTests::testRawHeights(const Image & input, MapGen::ThreadPool & threadPool)
+{
+	const std::string size = sizeName(input);
+	checkRawOverloads(makeR16(input), size + " raw r16", threadPool);
+	checkRawOverloads(makeR32F(input), size + " raw r32", threadPool);
+	checkRawOverloads(makeRGBA16(input), size + " raw rgba16", threadPool);
+
+	// mapped from a file with a header to skip, the same as the samples in memory
+	const RawHeights r16 = makeR16(input);
+	std::vector<unsigned char> file(16 + r16.bytes.size(), 0xee);
+	std::copy(r16.bytes.begin(), r16.bytes.end(), file.begin() + 16);
+	const std::string path = "ImageMapGenTests_raw.r16";
+	check(writeFile(path, file), size + " raw r16 file written");
+
+	MapGen::RawHeightMap map;
+	check(map.open(path, MapGen::RawHeightFormat::R16, input.width, input.height, 16) && map.isOpen(), size + " raw r16 file opened");
+	Image fromFile(input.width, input.height);
+	MapGen::generateNormalMap(map.view(), fromFile.view(), MapGen::NormalMapSettings());
+	checkSame(fromFile, referenceNormalMap(r16.grid, MapGen::NormalMapSettings()), size + " raw r16 file");
+	map.close();
+	check(!map.isOpen(), size + " raw r16 file closed");
+	std::remove(path.c_str());
+}
+
+// a size worked out from the file has to use every sample exactly, one given can leave samples over
+void MapGenTests::testRawHeightFiles()
+{
+	struct FileSize
+	{
+		const char * what;
+		size_t bytes;
+		int width, height;
+		bool opens;
+		int openedWidth, openedHeight;
+	};
+
+	const FileSize sizes[] =
+	{
+		{ "square", 100 * 100 * 2, 0, 0, true, 100, 100 },
+		{ "not square", 100 * 101 * 2, 0, 0, false, 0, 0 },
+		{ "not square with its size", 100 * 101 * 2, 100, 101, true, 100, 101 },
+		{ "not square with its width", 100 * 101 * 2, 100, 0, true, 100, 101 },
+		{ "width not dividing the samples", 100 * 101 * 2, 99, 0, false, 0, 0 },
+		{ "partial sample", 100 * 100 * 2 + 1, 0, 0, false, 0, 0 },
+		{ "partial sample with its size", 100 * 100 * 2 + 1, 100, 100, true, 100, 100 },
+		{ "smaller than its size", 100 * 100 * 2, 100, 101, false, 0, 0 },
+		{ "empty", 0, 0, 0, false, 0, 0 }
+	};
+
+	const std::string path = "ImageMapGenTests_size.r16";
+	for (const FileSize & size : sizes)
+	{
+		writeFile(path, std::vector<unsigned char>(size.bytes, 1));
+
+		MapGen::RawHeightMap map;
+		const bool opened = map.open(path, MapGen::RawHeightFormat::R16, size.width, size.height);
+		check(opened == size.opens && (!opened || (map.view().width == size.openedWidth && map.view().height == size.openedHeight)),
+			std::string("raw height file ") + size.what);
+	}
+	std::remove(path.c_str());
+
+	MapGen::RawHeightMap map;
+	check(!map.open("ImageMapGenTests_missing.r16", MapGen::RawHeightFormat::R16), "missing raw height file");
+
+	MapGen::RawHeightFormat format;
+	check(MapGen::RawHeightMap::formatFromFileName("terrain.r16", format) && format == MapGen::RawHeightFormat::R16, "r16 format from the file name");
+	check(MapGen::RawHeightMap::formatFromFileName("terrain.raw", format) && format == MapGen::RawHeightFormat::R16, "raw format from the file name");
+	check(MapGen::RawHeightMap::formatFromFileName("terrain.r32", format) && format == MapGen::RawHeightFormat::R32F, "r32 format from the file name");
+	check(!MapGen::RawHeightMap::formatFromFileName("terrain.png", format), "no raw format for a png");
+}
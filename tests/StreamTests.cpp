@@ -0,0 +1,167 @@
+#include "TestSupport.h"
+
+#include <PnmStream.h>
+
+#include <cstdio>
+
+namespace
+{
+	using MapGen::Pixel;
+	using MapGenTests::HeightGrid;
+	using MapGenTests::Image;
+
+	// hands over the grid's rows, failing at failAtRow
+	class GridRowSource : public MapGen::HeightRowSource
+	{
+	public:
+		GridRowSource(const HeightGrid & grid, int failAtRow = -1) : m_grid(grid), m_row(0), m_failAtRow(failAtRow) {}
+
+		int width() const override { return m_grid.width; }
+		int height() const override { return m_grid.height; }
+
+		bool readRow(float * heights) override
+		{
+			if (m_row >= m_grid.height || m_row == m_failAtRow)
+			{
+				return false;
+			}
+			std::copy(m_grid.heights.begin() + static_cast<size_t>(m_row) * m_grid.width,
+				m_grid.heights.begin() + static_cast<size_t>(m_row + 1) * m_grid.width, heights);
+			++m_row;
+			return true;
+		}
+
+	private:
+		const HeightGrid & m_grid;
+		int m_row, m_failAtRow;
+	};
+
+	class ImageRowSink : public MapGen::PixelRowSink
+	{
+	public:
+		explicit ImageRowSink(Image & image) : m_image(image), m_row(0) {}
+
+		bool writeRow(const Pixel * row) override
+		{
+			if (m_row >= m_image.height)
+			{
+				return false;
+			}
+			std::copy(row, row + m_image.width, m_image.pixels.begin() + static_cast<size_t>(m_row) * m_image.width);
+			++m_row;
+			return true;
+		}
+
+	private:
+		Image & m_image;
+		int m_row;
+	};
+
+	bool writePpm(const std::string & path, const Image & image)
+	{
+		std::vector<unsigned char> bytes;
+		const std::string header = "P6\n# height map\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+		bytes.insert(bytes.end(), header.begin(), header.end());
+		for (Pixel px : image.pixels)
+		{
+			bytes.push_back(static_cast<unsigned char>(MapGen::pixelRed(px)));
+			bytes.push_back(static_cast<unsigned char>(MapGen::pixelGreen(px)));
+			bytes.push_back(static_cast<unsigned char>(MapGen::pixelBlue(px)));
+		}
+		return MapGenTests::writeFile(path, bytes);
+	}
+
+	// just the files PpmRowWriter writes, no comments
+	bool readPpm(const std::vector<unsigned char> & file, Image & image)
+	{
+		int width = 0, height = 0, maxValue = 0, headerBytes = 0;
+		const std::string start(file.begin(), file.begin() + std::min<size_t>(file.size(), 64));
+		if (std::sscanf(start.c_str(), "P6 %d %d %d%n", &width, &height, &maxValue, &headerBytes) != 3 || maxValue != 255)
+		{
+			return false;
+		}
+		++headerBytes;
+		if (file.size() != static_cast<size_t>(headerBytes) + static_cast<size_t>(width) * height * 3)
+		{
+			return false;
+		}
+
+		image = Image(width, height);
+		for (size_t i = 0; i < image.pixels.size(); ++i)
+		{
+			const unsigned char * px = &file[headerBytes + i * 3];
+			image.pixels[i] = MapGen::makePixel(px[0], px[1], px[2]);
+		}
+		return true;
+	}
+}
+
+// streamed a row at a time the normal map is the same as the whole image at once, & a row that can't be read or
+// written fails the generation
+void MapGenTests::testStreaming(const Image & input)
+{
+	const std::string size = sizeName(input);
+	const HeightGrid grid = heightsOf(input);
+
+	for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+	{
+		const std::string name = size + " " + settingsName(settings);
+		Image output(input.width, input.height);
+		GridRowSource source(grid);
+		ImageRowSink sink(output);
+		const bool streamed = MapGen::generateNormalMap(source, sink, settings);
+
+		// wrapping needs the bottom row before the top one, so it can't be streamed
+		if (settings.border == MapGen::BorderMode::Wrap)
+		{
+			check(!streamed, name + " streaming fails");
+		}
+		else
+		{
+			check(streamed, name + " streamed");
+			checkSame(output, referenceNormalMap(grid, settings), name + " streamed");
+		}
+	}
+
+	Image output(input.width, input.height);
+	GridRowSource failingSource(grid, input.height / 2);
+	ImageRowSink sink(output);
+	check(!MapGen::generateNormalMap(failingSource, sink, MapGen::NormalMapSettings()), size + " streaming fails when a row can't be read");
+
+	Image tooShort(input.width, input.height - 1);
+	GridRowSource source(grid);
+	ImageRowSink shortSink(tooShort);
+	check(!MapGen::generateNormalMap(source, shortSink, MapGen::NormalMapSettings()), size + " streaming fails when a row can't be written");
+
+	// an 8 bit PPM gives the same heights as the image, & the PPM written out reads back as the normal map
+	const std::string inputPath = "ImageMapGenTests_stream_in.ppm";
+	const std::string outputPath = "ImageMapGenTests_stream_out.ppm";
+	check(writePpm(inputPath, input), size + " ppm written");
+
+	MapGen::PnmHeightReader reader;
+	check(reader.open(inputPath) && reader.width() == input.width && reader.height() == input.height, size + " ppm opened");
+	std::vector<float> row(input.width);
+	bool sameHeights = true;
+	for (int y = 0; y < input.height; ++y)
+	{
+		sameHeights = sameHeights && reader.readRow(row.data())
+			&& std::equal(row.begin(), row.end(), grid.heights.begin() + static_cast<size_t>(y) * input.width);
+	}
+	check(sameHeights, size + " ppm heights same as the image's");
+	check(!reader.readRow(row.data()), size + " nothing read past the last row");
+	reader.close();
+
+	check(reader.open(inputPath), size + " ppm opened again");
+	MapGen::PpmRowWriter writer;
+	check(writer.open(outputPath, input.width, input.height), size + " ppm output opened");
+	check(MapGen::generateNormalMap(reader, writer, MapGen::NormalMapSettings()), size + " ppm streamed");
+	check(writer.close(), size + " ppm output written");
+	reader.close();
+
+	Image written(0, 0);
+	check(readPpm(readFile(outputPath), written) && differingPixels(written, referenceNormalMap(grid, MapGen::NormalMapSettings())) == 0
+		&& written.width == input.width && written.height == input.height, size + " ppm streamed reads back as the normal map");
+
+	std::remove(inputPath.c_str());
+	std::remove(outputPath.c_str());
+}
@@ -0,0 +1,63 @@
+#include "TestSupport.h"
+
+#include <climits>
+
+namespace
+{
+	// every task run back to front, so nothing depends on the bands going in order
+	void runTasks(const std::vector<std::function<void()>> & tasks)
+	{
+		for (auto task = tasks.rbegin(); task != tasks.rend(); ++task)
+		{
+			(*task)();
+		}
+	}
+}
+
+// the tasks of one map, run out of order with bands of a row or less, a few rows & the whole map, give the same output as
+// generating it in one go
+void MapGenTests::testTasks(const Image & input)
+{
+	const std::string size = sizeName(input);
+	const HeightGrid grid = heightsOf(input);
+	const MapGen::RawHeightView floats(reinterpret_cast<const unsigned char *>(grid.heights.data()), input.width, input.height, input.width * sizeof(float), MapGen::RawHeightFormat::R32F);
+	const int pixels = input.width * input.height;
+
+	for (int bandPixels : { 1, 4096, INT_MAX })
+	{
+		const std::string band = " tasks of " + std::to_string(bandPixels) + " pixels";
+
+		for (const MapGen::NormalMapSettings & settings : normalSettingsToCheck())
+		{
+			const std::string name = size + " " + settingsName(settings) + band;
+			const Image expected = referenceNormalMap(grid, settings);
+			Image output(input.width, input.height);
+
+			const std::vector<std::function<void()>> tasks = MapGen::normalMapTasks(input.constView(), output.view(), settings, bandPixels);
+			check(!tasks.empty() && (pixels > bandPixels || tasks.size() == 1), name + " count");
+			runTasks(tasks);
+			checkSame(output, expected, name);
+
+			output.clear();
+			runTasks(MapGen::normalMapTasks(floats, output.view(), settings, bandPixels));
+			checkSame(output, expected, name + " raw r32");
+		}
+
+		for (MapGen::EdgeDetector detector : { MapGen::EdgeDetector::Difference, MapGen::EdgeDetector::Sobel, MapGen::EdgeDetector::Canny })
+		{
+			MapGen::EdgeMapSettings settings;
+			settings.detector = detector;
+			settings.sensitivity = 50;
+			const std::string name = size + " edge detector " + std::to_string(static_cast<int>(detector)) + band;
+
+			Image serial(input.width, input.height);
+			MapGen::generateEdgeMap(input.constView(), serial.view(), settings);
+
+			Image output(input.width, input.height);
+			const std::vector<std::function<void()>> tasks = MapGen::edgeMapTasks(input.constView(), output.view(), settings, bandPixels);
+			check(!tasks.empty() && ((pixels > bandPixels && detector != MapGen::EdgeDetector::Canny) || tasks.size() == 1), name + " count");
+			runTasks(tasks);
+			checkSame(output, serial, name);
+		}
+	}
+}
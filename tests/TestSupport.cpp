@@ -0,0 +1,251 @@
+#include "TestSupport.h"
+
+#include <JoshMath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	int checks = 0;
+	int failures = 0;
+
+	// the weight of the rows (or columns) either side & of the centre one, no outside weight for the central difference
+	void stencilWeights(MapGen::GradientStencil stencil, int & outer, int & centre)
+	{
+		switch (stencil)
+		{
+		case MapGen::GradientStencil::Sobel:
+			outer = 1;
+			centre = 2;
+			break;
+		case MapGen::GradientStencil::Scharr:
+			outer = 3;
+			centre = 10;
+			break;
+		case MapGen::GradientStencil::Prewitt:
+			outer = 1;
+			centre = 1;
+			break;
+		default:
+			outer = 0;
+			centre = 1;
+			break;
+		}
+	}
+}
+
+void MapGenTests::check(bool passed, const std::string & what)
+{
+	++checks;
+	if (!passed)
+	{
+		++failures;
+		printf("FAIL %s\n", what.c_str());
+		fflush(stdout);
+	}
+}
+
+int MapGenTests::checkCount()
+{
+	return checks;
+}
+
+int MapGenTests::failureCount()
+{
+	return failures;
+}
+
+MapGenTests::Image MapGenTests::makeHeightImage(int width, int height, uint32_t seed)
+{
+	Image image(width, height);
+	uint32_t noise = seed;
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			noise = noise * 1664525u + 1013904223u;
+			const float hills = 0.5f + 0.25f * sinf(x * 0.05f) + 0.2f * cosf(y * 0.07f);
+			const int step = ((x / 37 + y / 29) % 3 == 0) ? 60 : 0;
+			const int grey = std::min(255, std::max(0, static_cast<int>(hills * 180.0f) + step + static_cast<int>(noise >> 29)));
+			const int red = std::min(255, grey + static_cast<int>((noise >> 20) & 7));
+			image.pixel(x, y) = MapGen::makePixel(red, grey, std::max(0, grey - 3));
+		}
+	}
+	return image;
+}
+
+std::string MapGenTests::sizeName(const Image & image)
+{
+	return std::to_string(image.width) + "x" + std::to_string(image.height);
+}
+
+int MapGenTests::differingPixels(const Image & a, const Image & b)
+{
+	int differing = 0;
+	for (size_t i = 0; i < a.pixels.size(); ++i)
+	{
+		differing += a.pixels[i] != b.pixels[i];
+	}
+	return differing;
+}
+
+int MapGenTests::largestChannelDifference(const Image & a, const Image & b)
+{
+	int largest = 0;
+	for (size_t i = 0; i < a.pixels.size(); ++i)
+	{
+		largest = std::max(largest, std::abs(MapGen::pixelRed(a.pixels[i]) - MapGen::pixelRed(b.pixels[i])));
+		largest = std::max(largest, std::abs(MapGen::pixelGreen(a.pixels[i]) - MapGen::pixelGreen(b.pixels[i])));
+		largest = std::max(largest, std::abs(MapGen::pixelBlue(a.pixels[i]) - MapGen::pixelBlue(b.pixels[i])));
+	}
+	return largest;
+}
+
+void MapGenTests::checkSame(const Image & output, const Image & expected, const std::string & what)
+{
+	const int differing = differingPixels(output, expected);
+	check(differing == 0, what + " (" + std::to_string(differing) + " pixels differ)");
+}
+
+std::vector<unsigned char> MapGenTests::readFile(const std::string & path)
+{
+	std::vector<unsigned char> bytes;
+	std::FILE * file = std::fopen(path.c_str(), "rb");
+	if (!file)
+	{
+		return bytes;
+	}
+
+	unsigned char buffer[65536];
+	size_t read;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		bytes.insert(bytes.end(), buffer, buffer + read);
+	}
+	std::fclose(file);
+	return bytes;
+}
+
+bool MapGenTests::writeFile(const std::string & path, const std::vector<unsigned char> & bytes)
+{
+	std::FILE * file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	const bool written = bytes.empty() || std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	return std::fclose(file) == 0 && written;
+}
+
+float MapGenTests::HeightGrid::at(int x, int y, MapGen::BorderMode border) const
+{
+	// each direction on its own, so a corner clamps or wraps both ways
+	if (x < 0 || x >= width || y < 0 || y >= height)
+	{
+		switch (border)
+		{
+		case MapGen::BorderMode::Clamp:
+			x = std::min(std::max(x, 0), width - 1);
+			y = std::min(std::max(y, 0), height - 1);
+			break;
+		case MapGen::BorderMode::Wrap:
+			x = (x % width + width) % width;
+			y = (y % height + height) % height;
+			break;
+		default:
+			return 0.0f;
+		}
+	}
+	return heights[static_cast<size_t>(y) * width + x];
+}
+
+MapGenTests::HeightGrid MapGenTests::heightsOf(const Image & image)
+{
+	HeightGrid grid = { image.width, image.height, std::vector<float>(image.pixels.size()) };
+	for (size_t i = 0; i < image.pixels.size(); ++i)
+	{
+		grid.heights[i] = MapGen::calcHeightMapPx(image.pixels[i]);
+	}
+	return grid;
+}
+
+// s = (1, 0, amplitude * dx), t = (0, 1, amplitude * dy) & the unit s x t packed into a pixel. the amplitude multiplies
+// the difference, amplitude * (right - left). the very first window code multiplied each side first
+// (amplitude * right - amplitude * left), which rounds differently & moves the odd channel by one
+MapGenTests::Image MapGenTests::referenceNormalMap(const HeightGrid & grid, const MapGen::NormalMapSettings & settings)
+{
+	int outer, centre;
+	stencilWeights(settings.stencil, outer, centre);
+	const MapGen::BorderMode border = settings.border;
+
+	Image out(grid.width, grid.height);
+	for (int y = 0; y < grid.height; ++y)
+	{
+		for (int x = 0; x < grid.width; ++x)
+		{
+			float dx = grid.at(x + 1, y, border) - grid.at(x - 1, y, border);
+			float dy = grid.at(x, y - 1, border) - grid.at(x, y + 1, border);
+
+			// the 3x3 stencils weight in the rows & columns either side & divide by the total weight
+			if (outer > 0)
+			{
+				const float acrossOutside = (grid.at(x + 1, y - 1, border) - grid.at(x - 1, y - 1, border))
+					+ (grid.at(x + 1, y + 1, border) - grid.at(x - 1, y + 1, border));
+				const float verticalOutside = (grid.at(x - 1, y - 1, border) - grid.at(x - 1, y + 1, border))
+					+ (grid.at(x + 1, y - 1, border) - grid.at(x + 1, y + 1, border));
+				const float scale = 1.0f / static_cast<float>(outer * 2 + centre);
+				dx = (static_cast<float>(outer) * acrossOutside + static_cast<float>(centre) * dx) * scale;
+				dy = (static_cast<float>(outer) * verticalOutside + static_cast<float>(centre) * dy) * scale;
+			}
+
+			Vector3D s, t;
+			s.x = 1.0f;
+			s.y = 0.0f;
+			s.z = settings.amplitude * dx;
+			t.x = 0.0f;
+			t.y = 1.0f;
+			t.z = settings.amplitude * dy;
+
+			const Vector3D normal = Math::VectorMath::unitVector(Math::VectorMath::crossProduct(s, t));
+			out.pixel(x, y) = MapGen::vectorToPixel(normal);
+		}
+	}
+	return out;
+}
+
+std::vector<MapGen::NormalMapSettings> MapGenTests::normalSettingsToCheck()
+{
+	const MapGen::BorderMode borders[] = { MapGen::BorderMode::Zero, MapGen::BorderMode::Clamp, MapGen::BorderMode::Wrap };
+	const float amplitudes[] = { 1.0f, 3.5f, 10.0f, 25.0f };
+
+	const MapGen::GradientStencil stencils[] = { MapGen::GradientStencil::CentralDifference, MapGen::GradientStencil::Sobel,
+		MapGen::GradientStencil::Scharr, MapGen::GradientStencil::Prewitt };
+
+	std::vector<MapGen::NormalMapSettings> all;
+	for (MapGen::GradientStencil stencil : stencils)
+	{
+		for (MapGen::BorderMode border : borders)
+		{
+			for (float amplitude : amplitudes)
+			{
+				MapGen::NormalMapSettings settings;
+				settings.stencil = stencil;
+				settings.border = border;
+				settings.amplitude = amplitude;
+				all.push_back(settings);
+			}
+		}
+	}
+	return all;
+}
+
+std::string MapGenTests::settingsName(const MapGen::NormalMapSettings & settings)
+{
+	const char * border = settings.border == MapGen::BorderMode::Zero ? "zero" : settings.border == MapGen::BorderMode::Clamp ? "clamp" : "wrap";
+	const char * stencils[] = { "central difference", "sobel", "scharr", "prewitt" };
+	return std::string(stencils[static_cast<int>(settings.stencil)]) + " " + border + " border amplitude " + std::to_string(settings.amplitude);
+}
@@ -0,0 +1,85 @@
+#ifndef _TEST_SUPPORT_H_
+#define _TEST_SUPPORT_H_
+
+#include <Generators.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MapGenTests
+{
+	using MapGen::Pixel;
+
+	// counts the check & prints what failed
+	void check(bool passed, const std::string & what);
+	int checkCount();
+	int failureCount();
+
+	struct Image
+	{
+		int width, height;
+		std::vector<Pixel> pixels;
+
+		Image(int w, int h) : width(w), height(h), pixels(static_cast<size_t>(w) * h, 0) {}
+
+		MapGen::ConstImageView constView() const { return MapGen::ConstImageView(reinterpret_cast<const unsigned char *>(pixels.data()), width, height, width * sizeof(Pixel)); }
+		MapGen::ImageView view() { return MapGen::ImageView(reinterpret_cast<unsigned char *>(pixels.data()), width, height, width * sizeof(Pixel)); }
+		Pixel at(int x, int y) const { return pixels[static_cast<size_t>(y) * width + x]; }
+		Pixel & pixel(int x, int y) { return pixels[static_cast<size_t>(y) * width + x]; }
+		void clear() { std::fill(pixels.begin(), pixels.end(), 0); }
+	};
+
+	// rolling hills, noise & a few hard steps so there are gentle slopes, steep ones & edges everywhere
+	Image makeHeightImage(int width, int height, uint32_t seed);
+
+	// "477x445" etc.
+	std::string sizeName(const Image & image);
+	int differingPixels(const Image & a, const Image & b);
+	// largest difference in any of red, green or blue
+	int largestChannelDifference(const Image & a, const Image & b);
+	// checks the two are identical, naming how many pixels aren't if they're not
+	void checkSame(const Image & output, const Image & expected, const std::string & what);
+
+	// the whole file, empty if it can't be read
+	std::vector<unsigned char> readFile(const std::string & path);
+	bool writeFile(const std::string & path, const std::vector<unsigned char> & bytes);
+
+	// heights to run the per pixel maths over, what's past the edges follows the border mode
+	struct HeightGrid
+	{
+		int width, height;
+		std::vector<float> heights;
+
+		float at(int x, int y, MapGen::BorderMode border) const;
+	};
+
+	HeightGrid heightsOf(const Image & image);
+
+	// the original per pixel normal map, unit s x t packed into a pixel for every pixel
+	Image referenceNormalMap(const HeightGrid & grid, const MapGen::NormalMapSettings & settings);
+
+	// every combination of the normal map settings the generators are checked with
+	std::vector<MapGen::NormalMapSettings> normalSettingsToCheck();
+	std::string settingsName(const MapGen::NormalMapSettings & settings);
+
+	// the checks, each prints its failures
+	void testNormalMapOverloads(const Image & input, MapGen::ThreadPool & threadPool);
+	void testThreadPool();
+	void testBandedGeneration(const Image & input);
+	void testHeightField(const Image & input, MapGen::ThreadPool & threadPool);
+	void testGradientField(const Image & input, MapGen::ThreadPool & threadPool);
+	void testEdgeMaps(const Image & input, MapGen::ThreadPool & threadPool);
+	void testStreaming(const Image & input);
+	void testTasks(const Image & input);
+	void testRawHeights(const Image & input, MapGen::ThreadPool & threadPool);
+	void testRawHeightFiles();
+	void testMips(const Image & input, MapGen::ThreadPool & threadPool);
+	void testBlockCompression(const Image & input, MapGen::ThreadPool & threadPool);
+	void testImageWriters(const Image & image, MapGen::ThreadPool & threadPool);
+	void testBufferPool();
+	void testVectorMath();
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "TestSupport.h"
+
+#include <atomic>
+#include <memory>
+
+// every index handed out exactly once whatever the chunk size, & the banded generators giving the serial output
+// on pools of any size, including ones with more threads than rows
+void MapGenTests::testThreadPool()
+{
+	MapGen::ThreadPool threadPool(4);
+	for (int count : { 0, 1, 7, 1000 })
+	{
+		for (int chunkSize : { 1, 3, 64, 5000 })
+		{
+			std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count > 0 ? count : 1]);
+			for (int i = 0; i < count; ++i)
+			{
+				visits[i] = 0;
+			}
+
+			std::atomic<bool> tooLong(false);
+			threadPool.parallelFor(count, chunkSize, [&](int first, int last)
+			{
+				tooLong = tooLong || last - first > chunkSize;
+				for (int i = first; i < last; ++i)
+				{
+					++visits[i];
+				}
+			});
+
+			bool once = true;
+			for (int i = 0; i < count; ++i)
+			{
+				once = once && visits[i] == 1;
+			}
+			const std::string name = "parallel for " + std::to_string(count) + " in chunks of " + std::to_string(chunkSize);
+			check(once, name + " visits each index once");
+			check(!tooLong, name + " keeps to the chunk size");
+		}
+	}
+}
+
+void MapGenTests::testBandedGeneration(const Image & input)
+{
+	const std::string size = sizeName(input);
+
+	Image serialNormals(input.width, input.height), serialEdges(input.width, input.height);
+	MapGen::generateNormalMap(input.constView(), serialNormals.view(), MapGen::NormalMapSettings());
+	MapGen::generateEdgeMap(input.constView(), serialEdges.view(), MapGen::EdgeMapSettings());
+
+	for (unsigned int threads : { 1u, 2u, 3u, 7u, 16u })
+	{
+		MapGen::ThreadPool threadPool(threads);
+		const std::string name = size + " on " + std::to_string(threads) + " threads";
+
+		Image output(input.width, input.height);
+		MapGen::generateNormalMap(input.constView(), output.view(), MapGen::NormalMapSettings(), threadPool);
+		checkSame(output, serialNormals, name + " normal map same as serial");
+
+		output.clear();
+		MapGen::generateEdgeMap(input.constView(), output.view(), MapGen::EdgeMapSettings(), threadPool);
+		checkSame(output, serialEdges, name + " edge map same as serial");
+	}
+}
@@ -0,0 +1,119 @@
+#include "TestSupport.h"
+
+#include <JoshMath.h>
+
+#include <cmath>
+
+namespace
+{
+	// count vectors a float past the start of their arrays, so the batches load unaligned, & none of them zero
+	struct Vectors
+	{
+		std::vector<float> x, y, z;
+
+		Vectors(int count, uint32_t seed) : x(count + 1), y(count + 1), z(count + 1)
+		{
+			uint32_t noise = seed;
+			auto next = [&noise]()
+			{
+				noise = noise * 1664525u + 1013904223u;
+				return static_cast<float>(static_cast<int>(noise >> 8) % 20001 - 10000) * 0.001f;
+			};
+			for (int i = 0; i <= count; ++i)
+			{
+				x[i] = next();
+				y[i] = next();
+				z[i] = 0.5f + std::abs(next());
+			}
+		}
+
+		Vector3D at(int i) const
+		{
+			Vector3D v;
+			v.x = x[i + 1];
+			v.y = y[i + 1];
+			v.z = z[i + 1];
+			return v;
+		}
+
+		Vector3DSpan span() { return Vector3DSpan(x.data() + 1, y.data() + 1, z.data() + 1); }
+		ConstVector3DSpan constSpan() const { return ConstVector3DSpan(x.data() + 1, y.data() + 1, z.data() + 1); }
+	};
+
+	bool same(const Vector3D & a, const Vector3D & b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	// every vector of the result exactly what the per vector function gives
+	template<typename PerVector>
+	bool matches(const Vectors & result, int count, PerVector perVector)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			if (!same(result.at(i), perVector(i)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+// each batched function the same as its per vector one for counts either side of the SSE2 & AVX widths, & with the
+// result written over one of its inputs
+void MapGenTests::testVectorMath()
+{
+	using namespace Math::VectorMath;
+
+	for (int count : { 0, 1, 3, 7, 8, 9, 17, 1000 })
+	{
+		const std::string name = "vector math of " + std::to_string(count) + " vectors ";
+		const Vectors a(count, 1), b(count, 2);
+
+		std::vector<float> dots(count);
+		dotProduct(a.constSpan(), b.constSpan(), dots.data(), count);
+		bool dotsMatch = true;
+		for (int i = 0; i < count; ++i)
+		{
+			dotsMatch = dotsMatch && dots[i] == dotProduct(a.at(i), b.at(i));
+		}
+		check(dotsMatch, name + "dot product");
+
+		Vectors result(count, 3);
+		crossProduct(a.constSpan(), b.constSpan(), result.span(), count);
+		check(matches(result, count, [&](int i) { return crossProduct(a.at(i), b.at(i)); }), name + "cross product");
+		add(a.constSpan(), b.constSpan(), result.span(), count);
+		check(matches(result, count, [&](int i) { return add(a.at(i), b.at(i)); }), name + "add");
+		scaled(-2.75f, a.constSpan(), result.span(), count);
+		check(matches(result, count, [&](int i) { return scaled(-2.75f, a.at(i)); }), name + "scaled");
+		unitVector(a.constSpan(), result.span(), count);
+		check(matches(result, count, [&](int i) { return unitVector(a.at(i)); }), name + "unit vector");
+
+		// written over an input
+		Vectors aliased = a;
+		std::vector<float> aliasedDots(aliased.x);
+		dotProduct(ConstVector3DSpan(aliasedDots.data() + 1, aliased.y.data() + 1, aliased.z.data() + 1), b.constSpan(), aliasedDots.data() + 1, count);
+		bool aliasedDotsMatch = true;
+		for (int i = 0; i < count; ++i)
+		{
+			aliasedDotsMatch = aliasedDotsMatch && aliasedDots[i + 1] == dots[i];
+		}
+		check(aliasedDotsMatch, name + "dot product over an input");
+
+		crossProduct(aliased.constSpan(), b.constSpan(), aliased.span(), count);
+		check(matches(aliased, count, [&](int i) { return crossProduct(a.at(i), b.at(i)); }), name + "cross product over an input");
+
+		aliased = b;
+		add(a.constSpan(), aliased.constSpan(), aliased.span(), count);
+		check(matches(aliased, count, [&](int i) { return add(a.at(i), b.at(i)); }), name + "add over an input");
+
+		aliased = a;
+		scaled(-2.75f, aliased.constSpan(), aliased.span(), count);
+		check(matches(aliased, count, [&](int i) { return scaled(-2.75f, a.at(i)); }), name + "scaled over an input");
+
+		aliased = a;
+		unitVector(aliased.constSpan(), aliased.span(), count);
+		check(matches(aliased, count, [&](int i) { return unitVector(a.at(i)); }), name + "unit vector over an input");
+	}
+}
@@ -0,0 +1,47 @@
+#include "TestSupport.h"
+
+#include <cstdio>
+
+// checks every way of generating a map against a plain per pixel version of the maths & against each other, & that
+// the files the writers make read back to the pixels that went in. prints each failure & returns non zero if any
+
+int main()
+{
+	using namespace MapGenTests;
+
+	MapGen::ThreadPool threadPool(4);
+
+	// odd sizes so the SIMD blocks have tails & the bands don't divide evenly, & the smallest maps there can be
+	const int sizes[][2] = { { 477, 445 }, { 67, 31 }, { 1, 1 }, { 1, 9 }, { 9, 1 }, { 3, 2 } };
+	for (const auto & size : sizes)
+	{
+		const Image input = makeHeightImage(size[0], size[1], static_cast<uint32_t>(size[0] * 31 + size[1]));
+		testNormalMapOverloads(input, threadPool);
+		testBandedGeneration(input);
+		testHeightField(input, threadPool);
+		testGradientField(input, threadPool);
+		testEdgeMaps(input, threadPool);
+		testStreaming(input);
+		testTasks(input);
+		testRawHeights(input, threadPool);
+		testMips(input, threadPool);
+		testBlockCompression(input, threadPool);
+		testImageWriters(input, threadPool);
+	}
+
+	// big enough that the PNG writer deflates it in several chunks, with alpha that changes from pixel to pixel
+	Image translucent = makeHeightImage(701, 503, 7);
+	for (size_t i = 0; i < translucent.pixels.size(); ++i)
+	{
+		translucent.pixels[i] = (translucent.pixels[i] & 0x00ffffff) | (static_cast<Pixel>((i * 7) & 0xff) << 24);
+	}
+	testImageWriters(translucent, threadPool);
+
+	testThreadPool();
+	testRawHeightFiles();
+	testBufferPool();
+	testVectorMath();
+
+	printf("%d checks, %d failed\n", checkCount(), failureCount());
+	return failureCount() == 0 ? 0 : 1;
+}